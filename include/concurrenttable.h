@@ -0,0 +1,116 @@
+#ifndef CONCURRENTTABLE_H
+#define CONCURRENTTABLE_H
+
+#include <atomic>
+#include <vector>
+
+#include "types.h"
+
+/* Concurrent hash tables for the scaling benchmark
+ * Keys are the indexes of the simulator's key set, the tables never own them
+ * Every operation takes the key's hash code, so hashing is done by the caller */
+
+// Indexing method, same as IndexingList
+typedef int (*IndexingFunction)(int bincount, void* out);
+
+// Contention counters of one thread, padded to its own cache line
+typedef struct alignas(64) contention
+{
+    long long waits; // Lock was held by another thread
+    long long retries; // CAS failed, slot was taken by another thread
+} Contention;
+
+// Spin lock, padded to its own cache line
+typedef struct alignas(64) spinlock
+{
+    std::atomic<int> locked;
+} SpinLock;
+
+class ConcurrentTable
+{
+public:
+    ConcurrentTable(void** keySet, int* lengthSet, IndexingFunction indexing)
+        : keySet(keySet), lengthSet(lengthSet), indexing(indexing) {}
+    virtual ~ConcurrentTable() {}
+
+    // Insert if absent, return false if it is already in the table
+    virtual bool Insert(int key, uint32_t code, Contention* c) = 0;
+
+    // Return true if the key is in the table
+    virtual bool Lookup(int key, uint32_t code, Contention* c) = 0;
+
+protected:
+    void** keySet; // Key set of the simulator
+    int* lengthSet; // Lengths of the keys
+    IndexingFunction indexing; // Bucket of the hash code
+
+    bool SameKey(int a, int b); // Compare the bytes of two keys
+};
+
+// Chained table, one lock protects every stripeCount-th bucket
+class StripedTable : public ConcurrentTable
+{
+public:
+    StripedTable(void** keySet, int* lengthSet, IndexingFunction indexing,
+                 int keyCount, int bucketCount, int stripeCount);
+    ~StripedTable();
+
+    bool Insert(int key, uint32_t code, Contention* c);
+    bool Lookup(int key, uint32_t code, Contention* c);
+
+private:
+    int* head = 0; // First key of the bucket, -1 is empty
+    int* next = 0; // Next key of the key, a key is in the table at most once
+    uint32_t* codes = 0; // Hash code of the key
+    int bucketCount = 0;
+    SpinLock* stripes = 0;
+    int stripeCount = 0;
+};
+
+// Open addressing with linear probing, slots are claimed by CAS
+// Slot is (code << 32 | key + 1), 0 is empty
+class LockFreeTable : public ConcurrentTable
+{
+public:
+    LockFreeTable(void** keySet, int* lengthSet, IndexingFunction indexing, int slotCount);
+    ~LockFreeTable();
+
+    bool Insert(int key, uint32_t code, Contention* c);
+    bool Lookup(int key, uint32_t code, Contention* c);
+
+private:
+    std::atomic<uint64_t>* slots = 0;
+    int slotCount = 0;
+};
+
+// Independent chained tables, one per core, chosen by the high bits of the code
+// Each shard has its own lock and its own memory
+// Per core use routes a key only to the thread owning its shard, see ShardOf
+class ShardedTable : public ConcurrentTable
+{
+public:
+    ShardedTable(void** keySet, int* lengthSet, IndexingFunction indexing,
+                 int bucketCount, int shardCount);
+    ~ShardedTable();
+
+    bool Insert(int key, uint32_t code, Contention* c);
+    bool Lookup(int key, uint32_t code, Contention* c);
+
+    int ShardOf(uint32_t code); // Shard of the hash code
+
+private:
+    typedef struct alignas(64) shard
+    {
+        SpinLock lock;
+        std::vector<int> head; // First node of the bucket, -1 is empty
+        std::vector<int> keys; // Key of the node
+        std::vector<int> next; // Next node of the node
+        std::vector<uint32_t> codes; // Hash code of the node
+    } Shard;
+
+    Shard* shards = 0;
+    int shardCount = 0;
+    int bucketCount = 0; // Buckets per shard
+};
+
+#endif // CONCURRENTTABLE_H
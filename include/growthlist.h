@@ -0,0 +1,18 @@
+#ifndef GROWTHLIST_H
+#define GROWTHLIST_H
+
+// Growth policy ID
+typedef int GID;
+
+#define GID_DOUBLE          (0) // n * 2
+#define GID_ONE_HALF        (1) // n * 1.5
+#define GID_PRIME           (2) // The smallest prime over n * 2
+
+// Rehash method ID
+typedef int RID;
+
+#define RID_ALL             (0) // Move every key when the table grows
+#define RID_INCREMENTAL     (1) // Keep both tables, move a few bins per insertion
+#define RID_LINEAR          (2) // Linear hashing, split one bin at a time
+
+#endif // GROWTHLIST_H
@@ -0,0 +1,36 @@
+#ifndef HASHCACHE_H
+#define HASHCACHE_H
+
+#include <stddef.h>
+
+#include "hashlist.h"
+#include "types.h"
+
+/* On-disk cache of hash outputs
+ * One file per (hash id, hash version, seed, key set digest, code size)
+ * Files are written to a temporary name and renamed into place,
+ * so concurrent runs sharing a directory never see a partial file */
+
+typedef struct hashcacheentry
+{
+    void* base; // Start of the mapping
+    size_t size; // Size of the mapping
+    void* codes; // Hash codes inside the mapping
+} HashCacheEntry;
+
+// Digest of the key set, lengths and bytes of every key
+uint64_t HashCacheDigest(void** keySet, int* lengthSet, int keyCount);
+
+// Map the cached codes, return false if there is no valid entry
+// or its codes do not match the checksum
+bool HashCacheLoad(const char* dir, HID hid, uint32_t version, uint32_t seed,
+                   uint64_t digest, int keyCount, size_t codeSize, HashCacheEntry* entry);
+
+// Write the codes to the cache, return false if it is failed
+bool HashCacheStore(const char* dir, HID hid, uint32_t version, uint32_t seed,
+                    uint64_t digest, int keyCount, size_t codeSize, const void* codes);
+
+// Unmap the entry
+void HashCacheRelease(HashCacheEntry* entry);
+
+#endif // HASHCACHE_H
@@ -2,7 +2,9 @@
 #define HASHSIMULATOR_H
 
 #include "hashlist.h"
+#include "growthlist.h"
 #include "hashcodesize.h"
+#include "hashcache.h"
 #include "types.h"
 
 class HashSimulator
@@ -13,8 +15,26 @@ public:
 
     void AddKey(void* keyptr, int length); // Add key to the key set
 
+    void SetCacheDir(const char* dir); // Load and store hash codes in this directory
+
     void Test(); // Start the test, print results
 
+    void Sweep(const int* binCounts, int sweepCount); // Hash once, test many bin counts
+
+    void GrowthTest(GID gid, RID rid, int initialBins, double maxLoad); // Insert keys into a growing table
+
+    void AdversaryTest(int count); // Hostile keys piled into one bin
+
+    void FilterTest(int bitsPerKey, int k); // Bloom filter and count-min sketch
+
+    void ShardTest(int nodeCount, int virtualNodes); // Keys spread on nodes
+
+    void ConcurrencyTest(int maxThreads, int lookupPercent, int opsPerThread); // Shared table scaling
+
+    void GroupProbeTest(double maxLoad); // Metadata group table, H1/H2 split
+
+    void IngestFile(const char* path, int workerCount); // Read and hash a key file in a pipeline
+
 private:
     HID* HIDList = 0; // Arrasy of hash funcitons
     int HIDCount = 0; // The number of hash functions
@@ -26,6 +46,11 @@ private:
     int keyCount = 0; // The number of keys
     int capacity = 1; // Capcity of keyset
 
+    const char* cacheDir = 0; // Hash code cache directory, 0 is disabled
+    uint64_t keyDigest = 0; // Digest of the key set, used as cache key
+    bool keyDigestReady = false; // Is keyDigest up to date?
+    HashCacheEntry cacheEntry = {0, 0, 0}; // Mapping of the loaded codes
+
 #if HASH_CODE_SIZE == 32
     uint32_t* outputSet = 0; // Array of hash code
 #elif HASH_CODE_SIZE == 128
@@ -38,13 +63,37 @@ private:
     int binCount = 0; // The number of bins
 
     // Test
-    void HashingStart(HID hid); // Hash the keys
+    void HashingStart(HID hid); // Hash the keys, fill the bins
+    void MakeOutputSet(HID hid); // Hash the keys
+    void ReleaseOutputSet(); // Delete the hash codes
+    bool LoadOutputSet(HID hid); // Get the hash codes from the cache
+    void StoreOutputSet(HID hid); // Put the hash codes to the cache
 
     void ChiSquaredTest(HID hid); // Chi-squared test
     void AvalancheTest(HID hid); // Avalanche test
     void FillFactorTest(HID hid); // FillFactor test
 
     void HashingFinish(HID hid); // Initialize bins
+
+    // Sweep
+    void SweepHistogram(int indexing, int binCount, int* hist); // Fill hist from the hash codes
+
+    // Adversary
+    void ProbeReport(HID hid, void** keys, int* lengths, int count); // Hottest bin and probe cost
+
+    // Filter
+    void DeriveIndex(int method, int i, int k, uint64_t* out, uint32_t* block); // k values and the block hash of the ith key
+    void BloomReport(int method, bool blocked, int bitsPerKey, int k); // False positive rate, speed
+    void SketchReport(int method, int bitsPerKey, int k); // Overestimation, speed
+
+    // Shard
+    long long Place(HID hid, int method, int nodeCount, int virtualNodes, int* nodeOf); // Node of every key
+
+    // Concurrency
+    void ConcurrencyRun(HID hid, int variant, int threadCount, int lookupPercent, int opsPerThread); // One row
+
+    // Group probe
+    void GroupProbeRun(int split, double maxLoad); // One row
 };
 
 #endif // HASHSIMULATOR_H
@@ -0,0 +1,83 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <stddef.h>
+#include <atomic>
+
+#include "types.h"
+
+/* Pipelined key ingestion
+ * One reader fills fixed-size buffers from a file of newline separated keys,
+ * hashing workers take the filled buffers and give them back when done
+ * Buffers are passed by index through two lock-free rings */
+
+#define INGEST_CHUNK        (1 << 20) // Bytes read into one buffer
+#define INGEST_SLACK        (4096) // Room for the partial key of the previous buffer
+#define INGEST_PAD          (8) // Hashes may read a few bytes over a short key
+#define INGEST_DEPTH        (8) // Reads in flight
+
+// Bounded MPMC ring of ints (Vyukov)
+class IngestRing
+{
+public:
+    IngestRing(int capacity); // capacity is rounded up to a power of two
+    ~IngestRing();
+
+    bool Push(int value); // Return false if it is full
+    bool Pop(int* value); // Return false if it is empty
+
+private:
+    typedef struct alignas(64) cell
+    {
+        std::atomic<size_t> sequence;
+        int value;
+    } Cell;
+
+    Cell* cells = 0;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> tail; // Next push
+    alignas(64) std::atomic<size_t> head; // Next pop
+};
+
+// Keys are in data[begin, end), separated by '\n'
+typedef struct ingestbuffer
+{
+    char* data; // INGEST_SLACK + INGEST_CHUNK + INGEST_PAD bytes
+    int begin;
+    int end;
+    long long offset; // File offset of data + INGEST_SLACK
+    int length; // Bytes to read
+    bool done; // Read is completed
+} IngestBuffer;
+
+typedef struct ingestpipeline
+{
+    IngestBuffer* buffers = 0;
+    int bufferCount = 0;
+    IngestRing* freeRing = 0; // Buffers the reader may fill
+    IngestRing* fullRing = 0; // Buffers the workers may hash, -1 is the end
+
+    // Reader's results
+    bool uring = false; // io_uring is used, pread otherwise
+    bool uringFailed = false; // io_uring submission is failed, the rest is read by pread
+    long long bytes = 0; // Bytes read
+    long long skipped = 0; // Keys over INGEST_SLACK bytes across two buffers
+    long long stallNano = 0; // Reader waited for a free buffer, hashing is slower
+} IngestPipeline;
+
+// Make the buffers and the rings
+void IngestInit(IngestPipeline* p, int bufferCount, int workerCount);
+void IngestFree(IngestPipeline* p);
+
+// Read the whole file, then put workerCount ends to fullRing
+// Return false if the file is not readable
+bool IngestRead(IngestPipeline* p, const char* path, int workerCount);
+
+// Worker takes a filled buffer, -1 is the end
+// idleNano is increased by the waiting time, reading is slower
+int IngestPop(IngestPipeline* p, long long* idleNano);
+
+// Worker gives the buffer back to the reader
+void IngestRelease(IngestPipeline* p, int buffer);
+
+#endif // INGEST_H
@@ -0,0 +1,174 @@
+#include <string.h>
+
+#include "../include/types.h"
+
+/* Worst-case keys for the registered hash functions
+ * Invert : find a key whose hash code is the given code, seed is known
+ * Collide : make keys with the same hash code under every seed
+ * Keys are written to keys + i * stride, length of every key is same */
+
+// Multiplicative inverse of odd x, mod 2^32 (Newton's method)
+static inline uint32_t InverseOdd(uint32_t x)
+{
+    uint32_t inv = x; // Correct for the lowest 3 bits
+
+    for (int i = 0; i < 5; i++) {
+        inv *= 2 - x * inv; // Correct bits are doubled
+    }
+
+    return inv;
+}
+
+static inline uint32_t Rotl(uint32_t x, int r)
+{
+    return (x << r) | (x >> (32 - r));
+}
+
+static inline uint32_t Rotr(uint32_t x, int r)
+{
+    return (x >> r) | (x << (32 - r));
+}
+
+///////////////////////////////////////////////////////////////////////////
+// MurmurHash3_x86_32
+///////////////////////////////////////////////////////////////////////////
+
+#define MURMUR_C1 (0xcc9e2d51)
+#define MURMUR_C2 (0x1b873593)
+
+// Inverse of fmix32
+static uint32_t UnFmix32(uint32_t h)
+{
+    h ^= h >> 16; // h ^= h >> 16 is its own inverse
+    h *= InverseOdd(0xc2b2ae35);
+    h ^= (h >> 13) ^ (h >> 26);
+    h *= InverseOdd(0x85ebca6b);
+    h ^= h >> 16;
+
+    return h;
+}
+
+// Mixing of one block before it is xored to the state
+static inline uint32_t MixBlock(uint32_t k)
+{
+    k *= MURMUR_C1;
+    k = Rotl(k, 15);
+    k *= MURMUR_C2;
+
+    return k;
+}
+
+// Inverse of MixBlock
+static inline uint32_t UnMixBlock(uint32_t k)
+{
+    k *= InverseOdd(MURMUR_C2);
+    k = Rotr(k, 15);
+    k *= InverseOdd(MURMUR_C1);
+
+    return k;
+}
+
+// Every step of a 4 bytes key is invertible,
+// so any hash code can be reached when the seed is known
+bool MurmurHash3_x86_32_Invert(uint32_t code, uint32_t seed, void* key, int* length)
+{
+    uint32_t h = UnFmix32(code);
+
+    h ^= 4; // length
+    h = (h - 0xe6546b64) * InverseOdd(5);
+    h = Rotr(h, 13);
+    h = UnMixBlock(h ^ seed);
+
+    memcpy(key, &h, 4);
+    *length = 4;
+
+    return true;
+}
+
+// Differential cancellation, independent of the seed
+// Block pair (a, a') with MixBlock(a) ^ MixBlock(a') = 1 << 18
+// makes the state differ only in bit 31 after rotl 13, and *5 + c keeps it
+// Block pair (b, b') with MixBlock(b) ^ MixBlock(b') = 1 << 31 cancels it
+// Each 8 bytes stage is a free choice of one bit, t stages make 2^t keys
+int MurmurHash3_x86_32_Collide(int count, void* keys, int stride, int* length)
+{
+    int stages = 0;
+    uint8_t* key = 0;
+    uint32_t y1, y2, block;
+
+    while ((1LL << stages) < count) {
+        stages++;
+    }
+    if (stages == 0) {
+        stages = 1;
+    }
+
+    // Key is too long for the buffer
+    if (stages * 8 > stride) {
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        key = (uint8_t*)keys + (long long)i * stride;
+
+        for (int s = 0; s < stages; s++) {
+            // Any base value works, make it differ by stage
+            y1 = 0x9e3779b9 * (uint32_t)(2 * s + 1);
+            y2 = 0x7f4a7c15 * (uint32_t)(2 * s + 1);
+
+            if (i & (1 << s)) {
+                y1 ^= 1u << 18;
+                y2 ^= 1u << 31;
+            }
+
+            block = UnMixBlock(y1);
+            memcpy(key + s * 8, &block, 4);
+            block = UnMixBlock(y2);
+            memcpy(key + s * 8 + 4, &block, 4);
+        }
+    }
+    *length = stages * 8;
+
+    return count;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// CustomHash_32
+///////////////////////////////////////////////////////////////////////////
+
+// Hash code is bytes 2..5 of the key, the others are free
+bool CustomHash_32_Invert(uint32_t code, uint32_t, void* key, int* length)
+{
+    uint8_t* p = (uint8_t*)key;
+
+    p[0] = 'A';
+    p[1] = 'A';
+    memcpy(p + 2, &code, 4);
+    *length = 6;
+
+    return true;
+}
+
+// Bytes 0, 1, 6, 7 are ignored by the hash and the seed is not used
+int CustomHash_32_Collide(int count, void* keys, int stride, int* length)
+{
+    uint8_t* key = 0;
+    uint32_t fixed = 0x2a2a2a2a;
+
+    if (stride < 8) {
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        key = (uint8_t*)keys + (long long)i * stride;
+
+        key[0] = (uint8_t)i;
+        key[1] = (uint8_t)(i >> 8);
+        memcpy(key + 2, &fixed, 4);
+        key[6] = (uint8_t)(i >> 16);
+        key[7] = (uint8_t)(i >> 24);
+    }
+    *length = 8;
+
+    return count;
+}
@@ -0,0 +1,247 @@
+#include <string.h>
+
+#include "../include/concurrenttable.h"
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////
+// Common
+///////////////////////////////////////////////////////////////////////////
+
+static inline void Lock(SpinLock* l, Contention* c)
+{
+    // Test and test-and-set, count once per contended acquisition
+    if (l->locked.exchange(1, memory_order_acquire) == 0) {
+        return;
+    }
+
+    c->waits++;
+    do {
+        while (l->locked.load(memory_order_relaxed)) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        }
+    } while (l->locked.exchange(1, memory_order_acquire) != 0);
+}
+
+static inline void Unlock(SpinLock* l)
+{
+    l->locked.store(0, memory_order_release);
+}
+
+bool ConcurrentTable::SameKey(int a, int b)
+{
+    return a == b || (this->lengthSet[a] == this->lengthSet[b] &&
+                      memcmp(this->keySet[a], this->keySet[b], this->lengthSet[a]) == 0);
+}
+
+///////////////////////////////////////////////////////////////////////////
+// Striped lock
+///////////////////////////////////////////////////////////////////////////
+
+StripedTable::StripedTable(void** keySet, int* lengthSet, IndexingFunction indexing,
+                           int keyCount, int bucketCount, int stripeCount)
+    : ConcurrentTable(keySet, lengthSet, indexing)
+{
+    this->head = new int[bucketCount];
+    this->next = new int[keyCount];
+    this->codes = new uint32_t[keyCount];
+    this->bucketCount = bucketCount;
+    this->stripes = new SpinLock[stripeCount];
+    this->stripeCount = stripeCount;
+
+    for (int i = 0; i < bucketCount; i++) {
+        this->head[i] = -1;
+    }
+
+    for (int i = 0; i < stripeCount; i++) {
+        this->stripes[i].locked.store(0);
+    }
+}
+
+StripedTable::~StripedTable()
+{
+    delete[] this->stripes;
+    delete[] this->codes;
+    delete[] this->next;
+    delete[] this->head;
+}
+
+bool StripedTable::Insert(int key, uint32_t code, Contention* c)
+{
+    int bucket = this->indexing(this->bucketCount, &code);
+    SpinLock* l = &this->stripes[bucket % this->stripeCount];
+
+    Lock(l, c);
+    for (int k = this->head[bucket]; k != -1; k = this->next[k]) {
+        if (this->codes[k] == code && this->SameKey(k, key)) {
+            Unlock(l);
+            return false;
+        }
+    }
+
+    this->codes[key] = code;
+    this->next[key] = this->head[bucket];
+    this->head[bucket] = key;
+    Unlock(l);
+
+    return true;
+}
+
+bool StripedTable::Lookup(int key, uint32_t code, Contention* c)
+{
+    int bucket = this->indexing(this->bucketCount, &code);
+    SpinLock* l = &this->stripes[bucket % this->stripeCount];
+    bool found = false;
+
+    Lock(l, c);
+    for (int k = this->head[bucket]; k != -1; k = this->next[k]) {
+        if (this->codes[k] == code && this->SameKey(k, key)) {
+            found = true;
+            break;
+        }
+    }
+    Unlock(l);
+
+    return found;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// Lock-free open addressing
+///////////////////////////////////////////////////////////////////////////
+
+LockFreeTable::LockFreeTable(void** keySet, int* lengthSet, IndexingFunction indexing, int slotCount)
+    : ConcurrentTable(keySet, lengthSet, indexing)
+{
+    this->slots = new atomic<uint64_t>[slotCount];
+    this->slotCount = slotCount;
+
+    for (int i = 0; i < slotCount; i++) {
+        this->slots[i].store(0);
+    }
+}
+
+LockFreeTable::~LockFreeTable()
+{
+    delete[] this->slots;
+}
+
+bool LockFreeTable::Insert(int key, uint32_t code, Contention* c)
+{
+    uint64_t slot = (uint64_t)code << 32 | (uint32_t)(key + 1);
+    int i = this->indexing(this->slotCount, &code);
+    uint64_t cur = 0;
+
+    // Slot count is larger than the key count, an empty slot is always found
+    for (int probe = 0; probe < this->slotCount; probe++) {
+        cur = this->slots[i].load(memory_order_acquire);
+
+        if (cur == 0) {
+            if (this->slots[i].compare_exchange_strong(cur, slot, memory_order_acq_rel)) {
+                return true;
+            }
+            // Another thread took it, check what it put
+            c->retries++;
+        }
+
+        if ((uint32_t)(cur >> 32) == code && this->SameKey((int)(cur & 0xffffffff) - 1, key)) {
+            return false;
+        }
+
+        i = i + 1 == this->slotCount ? 0 : i + 1;
+    }
+
+    return false;
+}
+
+bool LockFreeTable::Lookup(int key, uint32_t code, Contention*)
+{
+    int i = this->indexing(this->slotCount, &code);
+    uint64_t cur = 0;
+
+    for (int probe = 0; probe < this->slotCount; probe++) {
+        cur = this->slots[i].load(memory_order_acquire);
+
+        if (cur == 0) {
+            return false;
+        }
+
+        if ((uint32_t)(cur >> 32) == code && this->SameKey((int)(cur & 0xffffffff) - 1, key)) {
+            return true;
+        }
+
+        i = i + 1 == this->slotCount ? 0 : i + 1;
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// Sharded per core
+///////////////////////////////////////////////////////////////////////////
+
+ShardedTable::ShardedTable(void** keySet, int* lengthSet, IndexingFunction indexing,
+                           int bucketCount, int shardCount)
+    : ConcurrentTable(keySet, lengthSet, indexing)
+{
+    this->shards = new Shard[shardCount];
+    this->shardCount = shardCount;
+    this->bucketCount = bucketCount;
+
+    for (int s = 0; s < shardCount; s++) {
+        this->shards[s].lock.locked.store(0);
+        this->shards[s].head.assign(bucketCount, -1);
+    }
+}
+
+ShardedTable::~ShardedTable()
+{
+    delete[] this->shards;
+}
+
+int ShardedTable::ShardOf(uint32_t code)
+{
+    // High bits choose the shard
+    return (int)((uint64_t)code * this->shardCount >> 32);
+}
+
+bool ShardedTable::Insert(int key, uint32_t code, Contention* c)
+{
+    Shard* s = &this->shards[this->ShardOf(code)];
+    int bucket = this->indexing(this->bucketCount, &code);
+
+    Lock(&s->lock, c);
+    for (int n = s->head[bucket]; n != -1; n = s->next[n]) {
+        if (s->codes[n] == code && this->SameKey(s->keys[n], key)) {
+            Unlock(&s->lock);
+            return false;
+        }
+    }
+
+    s->keys.push_back(key);
+    s->codes.push_back(code);
+    s->next.push_back(s->head[bucket]);
+    s->head[bucket] = (int)s->keys.size() - 1;
+    Unlock(&s->lock);
+
+    return true;
+}
+
+bool ShardedTable::Lookup(int key, uint32_t code, Contention* c)
+{
+    Shard* s = &this->shards[this->ShardOf(code)];
+    int bucket = this->indexing(this->bucketCount, &code);
+    bool found = false;
+
+    Lock(&s->lock, c);
+    for (int n = s->head[bucket]; n != -1; n = s->next[n]) {
+        if (s->codes[n] == code && this->SameKey(s->keys[n], key)) {
+            found = true;
+            break;
+        }
+    }
+    Unlock(&s->lock);
+
+    return found;
+}
@@ -0,0 +1,289 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/hashcache.h"
+
+/* Cache file layout
+ * [header (64 bytes)][keyCount * codeSize bytes of hash codes]
+ * The header repeats every field of the file name, so a renamed or
+ * truncated file is detected, and a checksum guards the codes
+ * against bit-rot, edits and copies
+ * The checksum reads 8 bytes words in 4 lanes, it is a few percent of the hashing */
+
+#define HASH_CACHE_MAGIC    (0x3145484341435348ULL) // "HSCACHE1"
+#define HASH_CACHE_FORMAT   (3)
+
+typedef struct hashcacheheader
+{
+    uint64_t magic;
+    uint32_t format;
+    uint32_t hid;
+    uint32_t version;
+    uint32_t seed;
+    uint32_t codeSize;
+    uint32_t keyCount;
+    uint64_t digest;
+    uint64_t checksum; // HashCacheChecksum of the codes
+    uint8_t pad[16]; // Keep the codes 64 bytes aligned
+} HashCacheHeader;
+
+static_assert(sizeof(HashCacheHeader) == 64, "cache header must be 64 bytes");
+
+#define DIGEST_M1 (0x9e3779b97f4a7c15ULL)
+#define DIGEST_M2 (0xff51afd7ed558ccdULL)
+
+#define DIGEST_LANES (8)
+
+static inline uint64_t Rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+// One 8 bytes word into the key's state
+static inline uint64_t DigestWord(uint64_t h, uint64_t w)
+{
+    h = (h ^ w) * DIGEST_M1;
+    return h ^ (h >> 29);
+}
+
+// Make the cache file's name
+static void MakePath(char* path, size_t size, const char* dir, HID hid, uint32_t version,
+                     uint32_t seed, uint64_t digest, size_t codeSize)
+{
+    snprintf(path, size, "%s/h%d_v%u_s%08x_c%zu_%016llx.hc",
+             dir, hid, version, seed, codeSize * 8, (unsigned long long)digest);
+}
+
+// Keys are read in 8 bytes words, the tail is read with fixed-size loads
+// that may overlap the previous word, never past the key
+// The length is mixed in, so "ab"+"c" and "a"+"bc" are different
+// Keys go to DIGEST_LANES lanes by index, the lanes have no dependency on each other
+// It is not cryptographic, the header and key count are checked too
+uint64_t HashCacheDigest(void** keySet, int* lengthSet, int keyCount)
+{
+    uint64_t lane[DIGEST_LANES] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint64_t h = 0;
+    uint64_t w = 0;
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+    const uint8_t* p = 0;
+    int n = 0;
+
+    for (int i = 0; i < keyCount; i++) {
+        p = (const uint8_t*)keySet[i];
+        n = lengthSet[i];
+        h = (uint64_t)n * DIGEST_M2;
+
+        if (n >= 8) {
+            for (; n > 8; n -= 8, p += 8) {
+                memcpy(&w, p, 8);
+                h = DigestWord(h, w);
+            }
+            // Last 8 bytes, overlaps the previous word
+            memcpy(&w, p + n - 8, 8);
+        } else if (n >= 4) {
+            memcpy(&lo, p, 4);
+            memcpy(&hi, p + n - 4, 4);
+            w = (uint64_t)hi << 32 | lo;
+        } else if (n > 0) {
+            w = (uint64_t)p[0] << 16 | (uint64_t)p[n >> 1] << 8 | p[n - 1];
+        } else {
+            w = 0;
+        }
+
+        lane[i % DIGEST_LANES] = Rotl64(lane[i % DIGEST_LANES] ^ h ^ w, 31) * DIGEST_M1;
+    }
+
+    // Fold the lanes and the key count
+    h = (uint64_t)keyCount;
+    for (int l = 0; l < DIGEST_LANES; l++) {
+        h = DigestWord(h, Rotl64(lane[l], 27));
+    }
+    h ^= h >> 33;
+    h *= DIGEST_M2;
+    h ^= h >> 33;
+
+    return h;
+}
+
+// Checksum of the codes, 8 bytes words go to 4 lanes by index,
+// the tail is zero padded and the size is mixed in
+static uint64_t HashCacheChecksum(const void* codes, size_t size)
+{
+    const uint8_t* p = (const uint8_t*)codes;
+    uint64_t lane[4] = {1, 2, 3, 4};
+    uint64_t h = 0;
+    uint64_t w = 0;
+    size_t words = size / 8;
+
+    for (size_t i = 0; i < words; i++) {
+        memcpy(&w, p + i * 8, 8);
+        lane[i % 4] = Rotl64(lane[i % 4] ^ w, 31) * DIGEST_M1;
+    }
+
+    w = 0;
+    memcpy(&w, p + words * 8, size % 8);
+
+    h = DigestWord((uint64_t)size, w);
+    for (int l = 0; l < 4; l++) {
+        h = DigestWord(h, lane[l]);
+    }
+    h ^= h >> 33;
+    h *= DIGEST_M2;
+    h ^= h >> 33;
+
+    return h;
+}
+
+bool HashCacheLoad(const char* dir, HID hid, uint32_t version, uint32_t seed,
+                   uint64_t digest, int keyCount, size_t codeSize, HashCacheEntry* entry)
+{
+    char path[4096];
+    struct stat st;
+    HashCacheHeader* header;
+    size_t expected = sizeof(HashCacheHeader) + (size_t)keyCount * codeSize;
+    void* map;
+    int fd;
+
+    MakePath(path, sizeof(path), dir, hid, version, seed, digest, codeSize);
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    // Size must match exactly, a short file is a broken write
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size != expected) {
+        close(fd);
+        return false;
+    }
+
+    // Codes are read right after, fault the pages in at once
+#if defined(MAP_POPULATE)
+    map = mmap(0, expected, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+#else
+    map = mmap(0, expected, PROT_READ, MAP_PRIVATE, fd, 0);
+#endif
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    // Every field must match the request, otherwise it is stale
+    header = (HashCacheHeader*)map;
+    if (header->magic != HASH_CACHE_MAGIC ||
+        header->format != HASH_CACHE_FORMAT ||
+        header->hid != (uint32_t)hid ||
+        header->version != version ||
+        header->seed != seed ||
+        header->codeSize != codeSize ||
+        header->keyCount != (uint32_t)keyCount ||
+        header->digest != digest) {
+        munmap(map, expected);
+        return false;
+    }
+
+    // Codes are broken, hash again
+    if (header->checksum != HashCacheChecksum((uint8_t*)map + sizeof(HashCacheHeader),
+                                              expected - sizeof(HashCacheHeader))) {
+        munmap(map, expected);
+        return false;
+    }
+
+    entry->base = map;
+    entry->size = expected;
+    entry->codes = (uint8_t*)map + sizeof(HashCacheHeader);
+
+    return true;
+}
+
+bool HashCacheStore(const char* dir, HID hid, uint32_t version, uint32_t seed,
+                    uint64_t digest, int keyCount, size_t codeSize, const void* codes)
+{
+    static int tmpCount = 0;
+    char path[4096];
+    char tmpPath[4096 + 64];
+    HashCacheHeader header;
+    size_t remain = (size_t)keyCount * codeSize;
+    const uint8_t* p = (const uint8_t*)codes;
+    ssize_t written;
+    int fd;
+
+    // Directory may already exist
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        return false;
+    }
+
+    MakePath(path, sizeof(path), dir, hid, version, seed, digest, codeSize);
+
+    // Unique temporary name per process and per call,
+    // concurrent writers never touch the same file
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp.%ld.%d", path, (long)getpid(), tmpCount++);
+
+    memset(&header, 0, sizeof(header));
+    header.magic = HASH_CACHE_MAGIC;
+    header.format = HASH_CACHE_FORMAT;
+    header.hid = hid;
+    header.version = version;
+    header.seed = seed;
+    header.codeSize = codeSize;
+    header.keyCount = keyCount;
+    header.digest = digest;
+    header.checksum = HashCacheChecksum(codes, remain);
+
+    fd = open(tmpPath, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    if (write(fd, &header, sizeof(header)) != (ssize_t)sizeof(header)) {
+        goto fail;
+    }
+
+    while (remain > 0) {
+        written = write(fd, p, remain);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            goto fail;
+        }
+        p += written;
+        remain -= written;
+    }
+
+    // Data must be on disk before the name is visible
+    if (fsync(fd) != 0) {
+        goto fail;
+    }
+    close(fd);
+
+    // Atomic replace, readers see the old file or the new one
+    if (rename(tmpPath, path) != 0) {
+        unlink(tmpPath);
+        return false;
+    }
+
+    return true;
+
+fail:
+    close(fd);
+    unlink(tmpPath);
+    return false;
+}
+
+void HashCacheRelease(HashCacheEntry* entry)
+{
+    if (entry->base) {
+        munmap(entry->base, entry->size);
+    }
+
+    entry->base = 0;
+    entry->size = 0;
+    entry->codes = 0;
+}
@@ -1,8 +1,20 @@
 #include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <iostream>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "../include/hashsimulator.h"
+#include "../include/concurrenttable.h"
+#include "../include/ingest.h"
 
 /* Test Hash Functions with Chi-squared test, Avalanche test, FillFactor test
  * At first, register hash functions, indexing methods, and names
@@ -17,11 +29,25 @@ using namespace std;
 // Hash Functions
 extern void MurmurHash3_x86_32(const void* key, int len, uint32_t seed, void* out);
 extern void CustomHash_32(const void* key, int len, uint32_t seed, void* out);
+extern void MurmurHash3_x64_128(const void* key, int len, uint32_t seed, void* out);
 
 // Indexing Methods
 extern int DivIndexing(int bincount, void* out);
 extern int ChooseMbit(int bincount, void* out);
 
+// Adversarial key generators
+extern bool MurmurHash3_x86_32_Invert(uint32_t code, uint32_t seed, void* key, int* length);
+extern bool CustomHash_32_Invert(uint32_t code, uint32_t seed, void* key, int* length);
+extern int MurmurHash3_x86_32_Collide(int count, void* keys, int stride, int* length);
+extern int CustomHash_32_Collide(int count, void* keys, int stride, int* length);
+
+// Placement Methods
+extern int JumpConsistentHash(uint64_t key, int nodeCount);
+extern int RendezvousScalar(uint32_t code, const uint32_t* salts, int nodeCount);
+extern int RendezvousVector(uint32_t code, const uint32_t* salts, int nodeCount);
+extern bool RendezvousVectorSupported();
+extern int RingLookup(uint32_t code, const uint32_t* points, const int* owners, int pointCount);
+
 // Hash Function pointer list
 // Index is same with HID
 static void (*HashList[])(const void* key, int len, uint32_t seed, void* out) =
@@ -46,6 +72,32 @@ static int (*IndexingList[])(int bincount, void* out) =
     DivIndexing,            // [HID_CUSTOM]
 };
 
+// Inverse function list, find a key of the hash code with the known seed
+// Index is same with HID
+static bool (*InvertList[])(uint32_t code, uint32_t seed, void* key, int* length) =
+{
+    MurmurHash3_x86_32_Invert,  // [HID_MURMUR3]
+    CustomHash_32_Invert,       // [HID_CUSTOM]
+};
+
+// Multicollision list, keys with the same hash code under every seed
+// Index is same with HID
+static int (*CollideList[])(int count, void* keys, int stride, int* length) =
+{
+    MurmurHash3_x86_32_Collide, // [HID_MURMUR3]
+    CustomHash_32_Collide,      // [HID_CUSTOM]
+};
+
+// Hash Function's version list
+// Index is same with HID
+// Increase it when the function's output is changed,
+// cached hash codes of the old version will be ignored
+static uint32_t HashVersionList[] =
+{
+    1,                      // [HID_MURMUR3]
+    1,                      // [HID_CUSTOM]
+};
+
 ///////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////
 
@@ -99,6 +151,13 @@ HashSimulator::~HashSimulator()
     delete[] this->lengthSet;
 }
 
+// Use the directory as hash code cache
+// Next runs with the same hash, seed and key set skip the hashing
+void HashSimulator::SetCacheDir(const char* dir)
+{
+    this->cacheDir = dir;
+}
+
 // Add the key's pointer to the simulator
 void HashSimulator::AddKey(void *keyptr, int length)
 {
@@ -135,6 +194,9 @@ void HashSimulator::AddKey(void *keyptr, int length)
 
     // Increase key count
     this->keyCount++;
+
+    // Key set is changed
+    this->keyDigestReady = false;
 }
 
 // Do the test, print the results
@@ -161,65 +223,159 @@ void HashSimulator::HashingStart(HID hid)
     // Index number
     int index = -1;
 
+    // Get the hash codes
+    this->MakeOutputSet(hid);
+
+    for (int i = 0; i < this->keyCount; i++) {
+        // Get the index
+        index = IndexingList[hid](this->binCount, &this->outputSet[i]);
+        assert(this->binCount - 1 >= index);
+
+        // Increase bin
+        this->bins[index]++;
+    }
+}
+
+// Hash the keys, or load the hash codes from the cache
+void HashSimulator::MakeOutputSet(HID hid)
+{
     // speed
     chrono::nanoseconds nano;
 
-    // Make hash code array
+    // Show the progress
+    cout << HashNameList[hid] << "'s hashing is started..." << endl;
+
+    if (this->LoadOutputSet(hid)) {
+        cout << HashNameList[hid] << "'s hash codes are loaded from cache" << endl;
+    } else {
+        // Make hash code array
 #if HASH_CODE_SIZE == 32
-    this->outputSet = new uint32_t[this->keyCount];
-    uint32_t out = 0;
+        this->outputSet = new uint32_t[this->keyCount];
+        uint32_t out = 0;
 #elif HASH_CODE_SIZE == 128
-    this->outputSet = new uint128_t[this->keyCount];
-    uint128_t out = 0;
+        this->outputSet = new uint128_t[this->keyCount];
+        uint128_t out;
 #endif
 
-    // Show the progress
-    cout << HashNameList[hid] << "'s hashing is started..." << endl;
+        // Speed check
+        chrono::system_clock::time_point start = chrono::system_clock::now();
+        for (int i = 0; i < this->keyCount; i++) {
+            // Get the hash code
+            HashList[hid](this->keySet[i], this->lengthSet[i], this->seed, &out);
+            assert(out != 0);
 
-    // Speed check
-    chrono::system_clock::time_point start = chrono::system_clock::now();
-    for (int i = 0; i < this->keyCount; i++) {
-        // Get the hash code
-        HashList[hid](this->keySet[i], this->lengthSet[i], this->seed, &out);
-        assert(out != 0);
+            // Push the result
+            this->outputSet[i] = out;
+        }
+        chrono::system_clock::time_point end = chrono::system_clock::now();
 
-        // Push the result
-        this->outputSet[i] = out;
+        nano = end - start;
 
-        // Get the index
-        index = IndexingList[hid](this->binCount, &out);
-        assert(this->binCount - 1 >= index);
+        cout << HashNameList[hid] << "'s hashing is over" << endl;
+        cout << "Speed : " << nano.count() << "(ns)" << endl;
 
-        // Increase bin
-        this->bins[index]++;
+        this->StoreOutputSet(hid);
     }
-    chrono::system_clock::time_point end = chrono::system_clock::now();
+    cout << "Size of key set : " << this->keyCount << endl << endl;
+}
 
-    nano = end - start;
+// Delete output set, or unmap it if it came from the cache
+void HashSimulator::ReleaseOutputSet()
+{
+    if (this->cacheEntry.base) {
+        HashCacheRelease(&this->cacheEntry);
+    } else {
+        delete[] this->outputSet;
+    }
+    this->outputSet = 0;
+}
+
+// Get the hash codes from the cache
+// Return false if the cache is disabled or there is no valid entry
+bool HashSimulator::LoadOutputSet(HID hid)
+{
+    if (this->cacheDir == 0) {
+        return false;
+    }
+
+    // Digest is calculated once per key set
+    if (!this->keyDigestReady) {
+        this->keyDigest = HashCacheDigest(this->keySet, this->lengthSet, this->keyCount);
+        this->keyDigestReady = true;
+    }
+
+    if (!HashCacheLoad(this->cacheDir, hid, HashVersionList[hid], this->seed, this->keyDigest,
+                       this->keyCount, sizeof(*this->outputSet), &this->cacheEntry)) {
+        return false;
+    }
+
+    // Use the mapping directly, it is read only
+#if HASH_CODE_SIZE == 32
+    this->outputSet = (uint32_t*)this->cacheEntry.codes;
+#elif HASH_CODE_SIZE == 128
+    this->outputSet = (uint128_t*)this->cacheEntry.codes;
+#endif
 
-    cout << HashNameList[hid] << "'s hashing is over" << endl;
-    cout << "Size of key set : " << this->keyCount << endl;
-    cout << "Speed : " << nano.count() << "(ns)" << endl << endl;
+    return true;
 }
 
-// Chi-squared test
-// Get the p-value and print it
-void HashSimulator::ChiSquaredTest(HID hid)
+// Put the hash codes to the cache
+void HashSimulator::StoreOutputSet(HID hid)
+{
+    if (this->cacheDir == 0) {
+        return;
+    }
+
+    // LoadOutputSet was failed before, so digest is ready
+    assert(this->keyDigestReady);
+
+    if (!HashCacheStore(this->cacheDir, hid, HashVersionList[hid], this->seed, this->keyDigest,
+                        this->keyCount, sizeof(*this->outputSet), this->outputSet)) {
+        cout << HashNameList[hid] << "'s hash codes are not cached" << endl;
+    }
+}
+
+// Chi-squared value of the bins
+static double ChiSquared(const int* bins, int binCount, int keyCount)
 {
     // Expected bin
-    double expectedPerBin = (double)this->keyCount / this->binCount;
+    double expectedPerBin = (double)keyCount / binCount;
 
     // Chi-squared value
     double chiValue = 0;
     double diff = 0;
 
+    for (int i = 0; i < binCount; i++) {
+        diff = bins[i] - expectedPerBin;
+        chiValue += diff * diff / expectedPerBin; // sum of (real - expected)^2 / expected
+    }
+
+    return chiValue;
+}
+
+// Wasted percentage of the bins, from the FillFactor
+static double WastedPercent(const int* bins, int binCount, int keyCount)
+{
+    // FillFactor
+    double f = 0;
+    double b = 0;
+
+    for (int i = 0; i < binCount; i++) {
+        b += (double)bins[i] * bins[i];
+    }
+    f = ((double)keyCount * keyCount) / b; // kk / nrr
+
+    return 100 * (1 - f / binCount);
+}
+
+// Chi-squared test
+// Get the p-value and print it
+void HashSimulator::ChiSquaredTest(HID hid)
+{
     cout << HashNameList[hid] << "'s Chi-squared test is started..." << endl;
 
     // Get the chi-squared value
-    for (int i = 0; i < this->binCount; i++) {
-        diff = this->bins[i] - expectedPerBin;
-        chiValue += diff * diff / expectedPerBin; // sum of (real - expected)^2 / expected
-    }
+    double chiValue = ChiSquared(this->bins, this->binCount, this->keyCount);
 
     cout << "Chi-squared value : " << chiValue << endl;
     cout << "DOF : " << this->binCount << endl << endl;
@@ -326,18 +482,9 @@ void HashSimulator::AvalancheTest(HID hid)
 // print the FillFactor
 void HashSimulator::FillFactorTest(HID hid)
 {
-    // FillFactor
-    double f = 0;
-    double b = 0;
-
     cout << HashNameList[hid] << "'s FillFactor test is started..." << endl;
 
-    for (int i = 0; i < this->binCount; i++) {
-        b += this->bins[i] * this->bins[i];
-    }
-    f = (double)(this->keyCount * this->keyCount) / b; // kk / nrr
-
-    cout << 100 * (1 - f / this->binCount) << "% is wasted..." << endl << endl;
+    cout << WastedPercent(this->bins, this->binCount, this->keyCount) << "% is wasted..." << endl << endl;
 }
 
 // Hashing is over
@@ -353,8 +500,1837 @@ void HashSimulator::HashingFinish(HID hid)
     cout << endl;
 
     // Delete output set
-    delete[] this->outputSet;
-    this->outputSet = 0;
+    this->ReleaseOutputSet();
 
     cout << HashNameList[hid] << "'s test is over..." << endl << endl;
 }
+
+
+
+///////////////////////////////////////////////////////////////////////////
+// Sweep, many bin counts from one hashing pass
+///////////////////////////////////////////////////////////////////////////
+
+// Power of two histogram is folded into the half size histogram
+#define FOLD_HALVES     (0) // Index is low bits, bin i and i + n/2 are merged
+#define FOLD_ADJACENT   (1) // Index is high bits, bin 2i and 2i+1 are merged
+
+// Indexing methods of the sweep
+static int (*SweepIndexingList[])(int bincount, void* out) =
+{
+    DivIndexing,
+    ChooseMbit,
+};
+
+static const char* SweepIndexingNameList[] =
+{
+    "Div",
+    "Mbit",
+};
+
+// How to derive the smaller power of two histogram
+static int SweepFoldList[] =
+{
+    FOLD_HALVES,            // x % 2^m is the low m bits
+    FOLD_ADJACENT,          // x >> (32 - m) is the high m bits
+};
+
+// Is the method valid only for power of two bin counts?
+static bool SweepPow2OnlyList[] =
+{
+    false,
+    true,
+};
+
+#define SWEEP_INDEXING_COUNT (2)
+
+static inline bool IsPowerOfTwo(int n)
+{
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+// Merge the bins of n size histogram into n/2 size histogram
+static void FoldHistogram(int* hist, int n, int fold)
+{
+    int half = n / 2;
+
+    if (fold == FOLD_HALVES) {
+        for (int i = 0; i < half; i++) {
+            hist[i] += hist[i + half];
+        }
+    } else {
+        // hist[2i], hist[2i+1] are never overwritten before they are read
+        for (int i = 0; i < half; i++) {
+            hist[i] = hist[2 * i] + hist[2 * i + 1];
+        }
+    }
+}
+
+// Fill the histogram with the indexing method
+void HashSimulator::SweepHistogram(int indexing, int binCount, int* hist)
+{
+    int index = -1;
+
+    for (int i = 0; i < binCount; i++) {
+        hist[i] = 0;
+    }
+
+    for (int i = 0; i < this->keyCount; i++) {
+        index = SweepIndexingList[indexing](binCount, &this->outputSet[i]);
+        assert(binCount - 1 >= index);
+
+        hist[index]++;
+    }
+}
+
+// Hash the keys once, then print chi-squared value and wasted percentage
+// of every bin count and every indexing method
+// Power of two bin counts are derived from the largest one by merging the bins
+void HashSimulator::Sweep(const int* binCounts, int sweepCount)
+{
+    int resultCount = sweepCount * SWEEP_INDEXING_COUNT;
+    double* chiValues = new double[resultCount];
+    double* wasted = new double[resultCount];
+    bool* valid = new bool[resultCount];
+    int maxPow2 = 0;
+    int maxCount = 0;
+    int* hist = 0;
+
+    for (int i = 0; i < sweepCount; i++) {
+        assert(binCounts[i] >= 2);
+
+        if (IsPowerOfTwo(binCounts[i]) && binCounts[i] > maxPow2) {
+            maxPow2 = binCounts[i];
+        }
+        if (binCounts[i] > maxCount) {
+            maxCount = binCounts[i];
+        }
+    }
+    hist = new int[maxCount];
+
+    // For all hashes
+    for (int h = 0; h < this->HIDCount; h++) {
+        HID hid = this->HIDList[h];
+
+        // One hashing pass
+        this->MakeOutputSet(hid);
+
+        cout << HashNameList[hid] << "'s sweep is started..." << endl;
+
+        for (int x = 0; x < SWEEP_INDEXING_COUNT; x++) {
+            for (int i = 0; i < sweepCount; i++) {
+                valid[x * sweepCount + i] = false;
+            }
+
+            // Power of two, the largest histogram is folded down
+            if (maxPow2 != 0) {
+                this->SweepHistogram(x, maxPow2, hist);
+
+                for (int n = maxPow2; n >= 2; n /= 2) {
+                    for (int i = 0; i < sweepCount; i++) {
+                        if (binCounts[i] == n) {
+                            chiValues[x * sweepCount + i] = ChiSquared(hist, n, this->keyCount);
+                            wasted[x * sweepCount + i] = WastedPercent(hist, n, this->keyCount);
+                            valid[x * sweepCount + i] = true;
+                        }
+                    }
+
+                    FoldHistogram(hist, n, SweepFoldList[x]);
+                }
+            }
+
+            // The others need their own pass over the hash codes
+            if (SweepPow2OnlyList[x]) {
+                continue;
+            }
+
+            for (int i = 0; i < sweepCount; i++) {
+                if (IsPowerOfTwo(binCounts[i])) {
+                    continue;
+                }
+
+                this->SweepHistogram(x, binCounts[i], hist);
+                chiValues[x * sweepCount + i] = ChiSquared(hist, binCounts[i], this->keyCount);
+                wasted[x * sweepCount + i] = WastedPercent(hist, binCounts[i], this->keyCount);
+                valid[x * sweepCount + i] = true;
+            }
+        }
+
+        // Print the table
+        cout << "bins\tindexing\tchi-squared\tDOF\twasted(%)" << endl;
+        for (int i = 0; i < sweepCount; i++) {
+            for (int x = 0; x < SWEEP_INDEXING_COUNT; x++) {
+                cout << binCounts[i] << "\t" << SweepIndexingNameList[x] << "\t\t";
+
+                if (valid[x * sweepCount + i]) {
+                    cout << chiValues[x * sweepCount + i] << "\t\t" << binCounts[i] << "\t"
+                         << wasted[x * sweepCount + i] << endl;
+                } else {
+                    cout << "-\t\t-\t-" << endl;
+                }
+            }
+        }
+        cout << endl;
+
+        this->ReleaseOutputSet();
+
+        cout << HashNameList[hid] << "'s sweep is over..." << endl << endl;
+    }
+
+    delete[] hist;
+    delete[] valid;
+    delete[] wasted;
+    delete[] chiValues;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+// Growth, keys are inserted one by one into a table that grows
+///////////////////////////////////////////////////////////////////////////
+
+// Growth policy's name list
+// Index is same with GID
+static const char* GrowthNameList[] =
+{
+    "Doubling",             // [GID_DOUBLE]
+    "1.5x",                 // [GID_ONE_HALF]
+    "Prime",                // [GID_PRIME]
+};
+
+// Rehash method's name list
+// Index is same with RID
+static const char* RehashNameList[] =
+{
+    "All at once",          // [RID_ALL]
+    "Incremental",          // [RID_INCREMENTAL]
+    "Linear",               // [RID_LINEAR]
+};
+
+// Old bins moved per insertion in incremental rehash
+#define INCREMENTAL_REHASH_STEP (4)
+
+// Node of the simulated chained table, only its size is used
+typedef struct simnode
+{
+    void* next;
+    void* key;
+    uint32_t code;
+} SimNode;
+
+// Simulated chained table
+// Keys are linked by their index, next[key] is the next key in the bin
+typedef struct simtable
+{
+    int* head; // First key of the bin, -1 is empty
+    int* length; // The number of keys in the bin
+    int binCount; // The number of bins in use
+    int capacity; // The number of allocated bins
+    int count; // The number of keys
+} SimTable;
+
+static void SimTableInit(SimTable* t, int binCount, int capacity)
+{
+    t->head = new int[capacity];
+    t->length = new int[capacity];
+    t->binCount = binCount;
+    t->capacity = capacity;
+    t->count = 0;
+
+    for (int i = 0; i < capacity; i++) {
+        t->head[i] = -1;
+        t->length[i] = 0;
+    }
+}
+
+static void SimTableFree(SimTable* t)
+{
+    delete[] t->head;
+    delete[] t->length;
+    t->head = 0;
+    t->length = 0;
+    t->binCount = 0;
+    t->capacity = 0;
+    t->count = 0;
+}
+
+static inline void SimTablePush(SimTable* t, int* next, int bin, int key)
+{
+    next[key] = t->head[bin];
+    t->head[bin] = key;
+    t->length[bin]++;
+    t->count++;
+}
+
+// Memory of the bin array
+static inline long long BinBytes(int capacity)
+{
+    return (long long)capacity * sizeof(void*);
+}
+
+static bool IsPrime(int n)
+{
+    if (n < 2) {
+        return false;
+    }
+
+    for (int d = 2; (long long)d * d <= n; d++) {
+        if (n % d == 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// The number of bins after the growth
+static int NextBinCount(GID gid, int n)
+{
+    int m = n;
+
+    switch (gid) {
+    case GID_DOUBLE:
+        m = n * 2;
+        break;
+    case GID_ONE_HALF:
+        m = n + (n + 1) / 2;
+        break;
+    case GID_PRIME:
+        m = n * 2 + 1;
+        while (!IsPrime(m)) {
+            m++;
+        }
+        break;
+    }
+
+    return m;
+}
+
+// Longest chain of the table
+static int LongestChain(const SimTable* t)
+{
+    int longest = 0;
+
+    for (int i = 0; i < t->binCount; i++) {
+        if (t->length[i] > longest) {
+            longest = t->length[i];
+        }
+    }
+
+    return longest;
+}
+
+// One row of the growth test
+// Quality is taken when the resize starts, at the highest load factor,
+// moved keys and memory are added until the resize is over
+typedef struct growthrow
+{
+    int resize;
+    int keys;
+    int bins;
+    int newBins;
+    double chi;
+    int longest;
+    long long moved; // Keys moved by this resize
+    long long bytes; // Peak memory while this resize is in progress
+} GrowthRow;
+
+// Take the table's quality at the current load factor
+static void GrowthRowInit(GrowthRow* row, int resize, const SimTable* t, int newBinCount)
+{
+    row->resize = resize;
+    row->keys = t->count;
+    row->bins = t->binCount;
+    row->newBins = newBinCount;
+    row->chi = ChiSquared(t->length, t->binCount, t->count);
+    row->longest = LongestChain(t);
+    row->moved = 0;
+    row->bytes = 0;
+}
+
+static void PrintGrowthRow(const GrowthRow* row)
+{
+    cout << row->resize << "\t" << row->keys << "\t" << (double)row->keys / row->bins << "\t"
+         << row->bins << "\t" << row->newBins << "\t"
+         << row->chi << "\t\t"
+         << row->longest << "\t" << row->moved << "\t" << row->bytes << endl;
+}
+
+// Memory of the tables, both bin arrays and every node
+static inline long long TableBytes(const SimTable* cur, const SimTable* old)
+{
+    return BinBytes(cur->capacity) + BinBytes(old->capacity)
+         + (long long)(cur->count + old->count) * sizeof(SimNode);
+}
+
+// Insert the keys one by one into a chained table
+// The table grows by the policy when the load factor is over maxLoad,
+// and the keys are moved by the rehash method
+// Print the quality, moved keys and peak memory of each resize,
+// the rehash work and the peak memory of all resizes
+// Linear rehash ignores the growth policy, the table grows one bin at a time,
+// one resize is one level
+void HashSimulator::GrowthTest(GID gid, RID rid, int initialBins, double maxLoad)
+{
+    assert(initialBins >= 1);
+    assert(maxLoad > 0);
+
+    for (int h = 0; h < this->HIDCount; h++) {
+        HID hid = this->HIDList[h];
+        int* next = new int[this->keyCount];
+        SimTable cur, old;
+        GrowthRow row; // Resize in progress
+        int migrate = 0; // Next old bin to be moved
+        int level = 0; // Linear hashing's level
+        int split = 0; // Linear hashing's split pointer
+        int resize = 0; // The number of growths
+        int work = 0; // Keys moved by this insertion
+        int maxWork = 0; // The worst insertion
+        long long moved = 0; // Keys moved by all insertions
+        long long bytes = 0;
+        long long peakBytes = 0; // Peak memory of all resizes
+        int bin = -1;
+        int key = -1;
+        chrono::nanoseconds nano;
+
+        this->MakeOutputSet(hid);
+
+        cout << HashNameList[hid] << "'s growth test is started..." << endl;
+        cout << "Growth : " << GrowthNameList[gid] << ", Rehash : " << RehashNameList[rid]
+             << ", Max load : " << maxLoad << endl;
+        cout << "resize\tkeys\tload\tbins\t->bins\tchi-squared\tlongest\tmoved\tbytes" << endl;
+
+        if (rid == RID_LINEAR) {
+            SimTableInit(&cur, initialBins, initialBins * 2);
+        } else {
+            SimTableInit(&cur, initialBins, initialBins);
+        }
+        old.head = 0;
+        old.length = 0;
+        old.binCount = 0;
+        old.capacity = 0;
+        old.count = 0;
+        row.moved = 0;
+        row.bytes = 0;
+
+        chrono::system_clock::time_point start = chrono::system_clock::now();
+        for (int i = 0; i < this->keyCount; i++) {
+            work = 0;
+
+            if (rid == RID_LINEAR) {
+                // Address with the current level, split bins use the next level
+                int low = initialBins << level;
+
+                bin = this->outputSet[i] % low;
+                if (bin < split) {
+                    bin = this->outputSet[i] % (low * 2);
+                }
+                SimTablePush(&cur, next, bin, i);
+
+                // Split one bin while the load is too high
+                while (cur.count > maxLoad * cur.binCount) {
+                    int target = split;
+
+                    // Bin array is full, reallocate it for the next level
+                    if (cur.binCount == cur.capacity) {
+                        SimTable grown;
+
+                        SimTableInit(&grown, cur.binCount, cur.capacity * 2);
+                        for (int j = 0; j < cur.binCount; j++) {
+                            grown.head[j] = cur.head[j];
+                            grown.length[j] = cur.length[j];
+                        }
+                        grown.count = cur.count;
+
+                        bytes = BinBytes(cur.capacity) + BinBytes(grown.capacity)
+                              + (long long)cur.count * sizeof(SimNode);
+                        if (bytes > row.bytes) {
+                            row.bytes = bytes;
+                        }
+
+                        SimTableFree(&cur);
+                        cur = grown;
+                    }
+
+                    // Move the keys of the split bin, to itself or to the new bin
+                    key = cur.head[target];
+                    cur.head[target] = -1;
+                    cur.count -= cur.length[target];
+                    cur.length[target] = 0;
+                    cur.binCount++;
+                    while (key != -1) {
+                        int nextKey = next[key];
+
+                        SimTablePush(&cur, next, this->outputSet[key] % (low * 2), key);
+                        work++;
+                        row.moved++;
+                        key = nextKey;
+                    }
+
+                    // One round is over, go to the next level
+                    split++;
+                    if (split == low) {
+                        long long levelMoved = row.moved;
+                        long long levelBytes = row.bytes;
+
+                        bytes = TableBytes(&cur, &old);
+                        if (bytes > levelBytes) {
+                            levelBytes = bytes;
+                        }
+                        if (levelBytes > peakBytes) {
+                            peakBytes = levelBytes;
+                        }
+
+                        GrowthRowInit(&row, ++resize, &cur, cur.binCount);
+                        row.moved = levelMoved;
+                        row.bytes = levelBytes;
+                        PrintGrowthRow(&row);
+
+                        row.moved = 0;
+                        row.bytes = 0;
+                        level++;
+                        split = 0;
+                        low *= 2;
+                    }
+                }
+            } else {
+                // Move a few old bins
+                if (old.binCount != 0) {
+                    for (int s = 0; s < INCREMENTAL_REHASH_STEP && migrate < old.binCount; s++) {
+                        key = old.head[migrate];
+                        while (key != -1) {
+                            int nextKey = next[key];
+
+                            bin = IndexingList[hid](cur.binCount, &this->outputSet[key]);
+                            SimTablePush(&cur, next, bin, key);
+                            work++;
+                            row.moved++;
+                            key = nextKey;
+                        }
+                        old.count -= old.length[migrate];
+                        migrate++;
+                    }
+
+                    // Rehash is over, its peak is taken by the previous insertions
+                    if (migrate == old.binCount) {
+                        SimTableFree(&old);
+                        PrintGrowthRow(&row);
+                    }
+                }
+
+                // Grow before the insertion makes the load too high
+                if (cur.count + old.count + 1 > maxLoad * cur.binCount) {
+                    SimTable grown;
+
+                    // Previous rehash is not over, finish it now
+                    if (old.binCount != 0) {
+                        for (; migrate < old.binCount; migrate++) {
+                            key = old.head[migrate];
+                            while (key != -1) {
+                                int nextKey = next[key];
+
+                                bin = IndexingList[hid](cur.binCount, &this->outputSet[key]);
+                                SimTablePush(&cur, next, bin, key);
+                                work++;
+                                row.moved++;
+                                key = nextKey;
+                            }
+                        }
+                        SimTableFree(&old);
+                        PrintGrowthRow(&row);
+                    }
+
+                    SimTableInit(&grown, NextBinCount(gid, cur.binCount),
+                                 NextBinCount(gid, cur.binCount));
+                    GrowthRowInit(&row, ++resize, &cur, grown.binCount);
+
+                    // Both bin arrays and all nodes are alive here
+                    row.bytes = TableBytes(&cur, &grown);
+                    if (row.bytes > peakBytes) {
+                        peakBytes = row.bytes;
+                    }
+
+                    if (rid == RID_ALL) {
+                        for (int j = 0; j < cur.binCount; j++) {
+                            key = cur.head[j];
+                            while (key != -1) {
+                                int nextKey = next[key];
+
+                                bin = IndexingList[hid](grown.binCount, &this->outputSet[key]);
+                                SimTablePush(&grown, next, bin, key);
+                                work++;
+                                row.moved++;
+                                key = nextKey;
+                            }
+                        }
+                        SimTableFree(&cur);
+                        PrintGrowthRow(&row);
+                    } else {
+                        old = cur;
+                        migrate = 0;
+                    }
+                    cur = grown;
+                }
+
+                bin = IndexingList[hid](cur.binCount, &this->outputSet[i]);
+                SimTablePush(&cur, next, bin, i);
+
+                // Both tables are alive while the rehash is in progress,
+                // the nodes keep growing until it is over
+                if (old.binCount != 0) {
+                    bytes = TableBytes(&cur, &old);
+                    if (bytes > row.bytes) {
+                        row.bytes = bytes;
+                    }
+                    if (bytes > peakBytes) {
+                        peakBytes = bytes;
+                    }
+                }
+            }
+
+            moved += work;
+            if (work > maxWork) {
+                maxWork = work;
+            }
+        }
+        chrono::system_clock::time_point end = chrono::system_clock::now();
+
+        nano = end - start;
+
+        // Keys left in the old table are still alive
+        bytes = TableBytes(&cur, &old);
+
+        if (old.binCount != 0) {
+            PrintGrowthRow(&row);
+            cout << "(rehash is not over, " << old.count << " keys are in the old bins)" << endl;
+            SimTableFree(&old);
+        } else {
+            GrowthRowInit(&row, resize, &cur, cur.binCount);
+            row.bytes = bytes;
+            PrintGrowthRow(&row);
+        }
+
+        cout << "Resize count : " << resize << endl;
+        cout << "Moved keys : " << moved << " (" << (double)moved / this->keyCount << " per key)" << endl;
+        cout << "Worst insertion : " << maxWork << " keys moved" << endl;
+        cout << "Peak memory in resizes : " << peakBytes << "(bytes)" << endl;
+        cout << "Final memory : " << bytes << "(bytes)" << endl;
+        cout << "Speed : " << nano.count() << "(ns)" << endl << endl;
+
+        SimTableFree(&cur);
+        delete[] next;
+
+        this->ReleaseOutputSet();
+
+        cout << HashNameList[hid] << "'s growth test is over..." << endl << endl;
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+// Adversary, keys made to land in one bin
+///////////////////////////////////////////////////////////////////////////
+
+// Buffer size of one generated key
+#define ADVERSARY_KEY_MAX (256)
+
+// Build a chained table of the keys, print the hottest bin,
+// the average probe count and the lookup time of every key
+void HashSimulator::ProbeReport(HID hid, void** keys, int* lengths, int count)
+{
+    uint32_t* codes = new uint32_t[count];
+    int* head = new int[this->binCount];
+    int* length = new int[this->binCount];
+    int* next = new int[count];
+    int hottest = 0;
+    long long probes = 0;
+    int found = 0;
+    uint32_t out = 0;
+    int index = -1;
+    chrono::nanoseconds nano;
+
+    for (int i = 0; i < this->binCount; i++) {
+        head[i] = -1;
+        length[i] = 0;
+    }
+
+    // Fill the chained table
+    for (int i = 0; i < count; i++) {
+        HashList[hid](keys[i], lengths[i], this->seed, &codes[i]);
+
+        index = IndexingList[hid](this->binCount, &codes[i]);
+        next[i] = head[index];
+        head[index] = i;
+        length[index]++;
+    }
+
+    // Successful search of a key at depth d costs d probes
+    for (int i = 0; i < this->binCount; i++) {
+        probes += (long long)length[i] * (length[i] + 1) / 2;
+        if (length[i] > hottest) {
+            hottest = length[i];
+        }
+    }
+
+    // Look up every key, hash it and walk the chain
+    chrono::system_clock::time_point start = chrono::system_clock::now();
+    for (int i = 0; i < count; i++) {
+        HashList[hid](keys[i], lengths[i], this->seed, &out);
+
+        index = IndexingList[hid](this->binCount, &out);
+        for (int k = head[index]; k != -1; k = next[k]) {
+            if (codes[k] == out && lengths[k] == lengths[i] &&
+                memcmp(keys[k], keys[i], lengths[i]) == 0) {
+                found++;
+                break;
+            }
+        }
+    }
+    chrono::system_clock::time_point end = chrono::system_clock::now();
+
+    nano = end - start;
+    assert(found == count);
+
+    cout << "Size of key set : " << count << endl;
+    cout << "Hottest bin : " << hottest << " (expected : " << (double)count / this->binCount << ")" << endl;
+    cout << "Average probes : " << (double)probes / count << endl;
+    cout << "Lookup : " << (double)nano.count() / count << "(ns) per key" << endl << endl;
+
+    delete[] next;
+    delete[] length;
+    delete[] head;
+    delete[] codes;
+}
+
+// Make the worst-case key sets of every hash for the bin count
+// 1. Inversion, the seed is known and every key is made for the hottest bin
+// 2. Multicollision, the keys have the same hash code under every seed
+// The key set added by AddKey is measured first for comparison
+void HashSimulator::AdversaryTest(int count)
+{
+    assert(HASH_CODE_SIZE == 32);
+
+    uint8_t* buffer = new uint8_t[(size_t)count * ADVERSARY_KEY_MAX];
+    void** keys = new void*[count];
+    int* lengths = new int[count];
+    int benignCount = count < this->keyCount ? count : this->keyCount;
+    int generated = 0;
+    int length = 0;
+    uint32_t code = 0;
+    uint32_t other = 0;
+    int hot = -1;
+    int differ = 0;
+
+    for (int i = 0; i < count; i++) {
+        keys[i] = buffer + (size_t)i * ADVERSARY_KEY_MAX;
+    }
+
+    for (int h = 0; h < this->HIDCount; h++) {
+        HID hid = this->HIDList[h];
+
+        cout << HashNameList[hid] << "'s adversary test is started..." << endl << endl;
+
+        // Normal keys
+        if (benignCount > 0) {
+            cout << "Key set" << endl;
+            this->ProbeReport(hid, this->keySet, this->lengthSet, benignCount);
+        }
+
+        // Inversion, codes of the hottest bin are chosen and inverted
+        // Multiples of binCount are tried first, then small codes
+        code = this->binCount;
+        hot = IndexingList[hid](this->binCount, &code);
+        generated = 0;
+        for (uint64_t j = 1; generated < count && j * this->binCount <= UINT32_MAX; j++) {
+            code = (uint32_t)(j * this->binCount);
+            if (IndexingList[hid](this->binCount, &code) == hot &&
+                InvertList[hid](code, this->seed, keys[generated], &lengths[generated])) {
+                generated++;
+            }
+        }
+        for (uint64_t j = 1; generated < count && j <= UINT32_MAX; j++) {
+            code = (uint32_t)j;
+            if (code % this->binCount != 0 &&
+                IndexingList[hid](this->binCount, &code) == hot &&
+                InvertList[hid](code, this->seed, keys[generated], &lengths[generated])) {
+                generated++;
+            }
+        }
+
+        cout << "Inversion (seed is known)" << endl;
+        this->ProbeReport(hid, keys, lengths, generated);
+
+        // Multicollision, no knowledge of the seed
+        generated = CollideList[hid](count, buffer, ADVERSARY_KEY_MAX, &length);
+        for (int i = 0; i < generated; i++) {
+            lengths[i] = length;
+        }
+
+        // Check the codes under another seed
+        differ = 0;
+        for (int i = 1; i < generated; i++) {
+            HashList[hid](keys[0], lengths[0], this->seed ^ 0x5bd1e995, &code);
+            HashList[hid](keys[i], lengths[i], this->seed ^ 0x5bd1e995, &other);
+            if (code != other) {
+                differ++;
+            }
+        }
+
+        cout << "Multicollision (seed is unknown)" << endl;
+        if (generated == 0) {
+            cout << "Not generated" << endl << endl;
+        } else {
+            cout << "Key length : " << length << ", different codes under another seed : " << differ << endl;
+            this->ProbeReport(hid, keys, lengths, generated);
+        }
+
+        cout << HashNameList[hid] << "'s adversary test is over..." << endl << endl;
+    }
+
+    delete[] lengths;
+    delete[] keys;
+    delete[] buffer;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+// Filter, Bloom filter and count-min sketch
+///////////////////////////////////////////////////////////////////////////
+
+// Index method of the filter
+// HID is k calls of the hash with seed, seed + 1, ..., seed + k - 1
+// FILTER_DOUBLE is one MurmurHash3_x64_128 call, g(i) = h1 + i * h2 + (i^3 - i) / 6
+// (Kirsch-Mitzenmacher double hashing, enhanced by Dillinger-Manolios)
+#define FILTER_DOUBLE   (-1)
+
+// Bits of a block in blocked Bloom filter, one cache line
+#define BLOOM_BLOCK_BITS (512)
+
+// Maximum k, derived values are kept on the stack
+#define FILTER_K_MAX    (32)
+
+// Name of the index method
+static inline const char* FilterMethodName(int method)
+{
+    return method == FILTER_DOUBLE ? "Double(x64_128)" : HashNameList[method];
+}
+
+// k values of the ith key
+// Keys are split, even keys are inserted, odd keys are queried as absent keys
+// block is the hash choosing the block of blocked Bloom filter, 0 if it is not needed
+// It comes from other bits than the low bits of out[], which set the bits in the block
+void HashSimulator::DeriveIndex(int method, int i, int k, uint64_t* out, uint32_t* block)
+{
+    if (method == FILTER_DOUBLE) {
+        uint64_t h[2];
+
+        MurmurHash3_x64_128(this->keySet[i], this->lengthSet[i], this->seed, h);
+
+        // Enhanced double hashing, the cubic term breaks the arithmetic
+        // progression, which overlaps a lot inside the 512 bits of a block
+        for (int j = 0; j < k; j++) {
+            out[j] = h[0] + j * h[1] + ((uint64_t)j * j * j - j) / 6;
+        }
+
+        // High half of h2, out[] only depends on its low bits
+        if (block) {
+            *block = h[1] >> 32;
+        }
+    } else {
+        uint32_t code = 0;
+
+        for (int j = 0; j < k; j++) {
+            HashList[method](this->keySet[i], this->lengthSet[i], this->seed + j, &code);
+            out[j] = code;
+        }
+
+        // Block is chosen by the high bits of the first code
+        if (block) {
+            *block = out[0];
+        }
+    }
+}
+
+// Block of the blocked Bloom filter, high bits of the block hash
+static inline uint64_t BloomBlock(uint32_t blockHash, uint64_t blockCount)
+{
+    return (uint64_t)blockHash * blockCount >> 32;
+}
+
+// Theoretical false positive rate of blocked Bloom filter
+// Keys per block is Poisson(n / blocks), each block is a small classic filter
+static double BlockedBloomFPR(double insertCount, double blockCount, int k)
+{
+    double lambda = insertCount / blockCount;
+    double p = exp(-lambda); // Poisson probability of i keys
+    double fpr = 0;
+    int last = (int)(lambda + 12 * sqrt(lambda) + 32);
+
+    for (int i = 0; i <= last; i++) {
+        fpr += p * pow(1 - pow(1 - 1.0 / BLOOM_BLOCK_BITS, (double)k * i), k);
+        p = p * lambda / (i + 1);
+    }
+
+    return fpr;
+}
+
+// Insert the even keys, query every key
+// Print false positive rate of the odd keys and the speed
+// Classic layout sets k bits anywhere in the array
+// Blocked layout picks one block by the block hash, k bits are in the block
+void HashSimulator::BloomReport(int method, bool blocked, int bitsPerKey, int k)
+{
+    int insertCount = (this->keyCount + 1) / 2;
+    int queryCount = this->keyCount / 2;
+    uint64_t bitCount = (uint64_t)insertCount * bitsPerKey;
+    uint64_t blockCount = 0;
+    uint64_t* bits = 0;
+    uint64_t out[FILTER_K_MAX];
+    uint64_t bit = 0;
+    uint64_t block = 0;
+    uint32_t blockHash = 0;
+    int falsePositive = 0;
+    int falseNegative = 0;
+    bool hit = false;
+    chrono::nanoseconds insertNano, queryNano;
+
+    // Round up to the block size, both layouts use the same memory
+    blockCount = (bitCount + BLOOM_BLOCK_BITS - 1) / BLOOM_BLOCK_BITS;
+    bitCount = blockCount * BLOOM_BLOCK_BITS;
+    bits = new uint64_t[bitCount / 64];
+    for (uint64_t i = 0; i < bitCount / 64; i++) {
+        bits[i] = 0;
+    }
+
+    // Insert
+    chrono::system_clock::time_point start = chrono::system_clock::now();
+    for (int i = 0; i < this->keyCount; i += 2) {
+        this->DeriveIndex(method, i, k, out, &blockHash);
+
+        if (blocked) {
+            block = BloomBlock(blockHash, blockCount);
+            for (int j = 0; j < k; j++) {
+                bit = block * BLOOM_BLOCK_BITS + out[j] % BLOOM_BLOCK_BITS;
+                bits[bit / 64] |= 1ULL << (bit % 64);
+            }
+        } else {
+            for (int j = 0; j < k; j++) {
+                bit = out[j] % bitCount;
+                bits[bit / 64] |= 1ULL << (bit % 64);
+            }
+        }
+    }
+    chrono::system_clock::time_point end = chrono::system_clock::now();
+    insertNano = end - start;
+
+    // Query, odd keys are not inserted
+    start = chrono::system_clock::now();
+    for (int i = 0; i < this->keyCount; i++) {
+        this->DeriveIndex(method, i, k, out, &blockHash);
+
+        hit = true;
+        if (blocked) {
+            block = BloomBlock(blockHash, blockCount);
+            for (int j = 0; j < k && hit; j++) {
+                bit = block * BLOOM_BLOCK_BITS + out[j] % BLOOM_BLOCK_BITS;
+                hit = bits[bit / 64] & (1ULL << (bit % 64));
+            }
+        } else {
+            for (int j = 0; j < k && hit; j++) {
+                bit = out[j] % bitCount;
+                hit = bits[bit / 64] & (1ULL << (bit % 64));
+            }
+        }
+
+        if (i % 2 == 1 && hit) {
+            falsePositive++;
+        } else if (i % 2 == 0 && !hit) {
+            falseNegative++;
+        }
+    }
+    end = chrono::system_clock::now();
+    queryNano = end - start;
+
+    assert(falseNegative == 0);
+
+    cout << FilterMethodName(method) << "	" << (blocked ? "Blocked" : "Classic") << "	"
+         << (queryCount ? (double)falsePositive / queryCount : 0) << "	"
+         << (blocked ? BlockedBloomFPR(insertCount, blockCount, k)
+                     : pow(1 - exp(-(double)k * insertCount / bitCount), k)) << "		"
+         << (double)insertNano.count() / insertCount << "		"
+         << (double)queryNano.count() / this->keyCount << endl;
+
+    delete[] bits;
+}
+
+// Count-min sketch, k rows of 32 bit counters in bitsPerKey bits per key
+// Even key i is inserted 1 + (i / 2) % 8 times
+// Print the overestimation of the inserted keys and the estimation of
+// the absent keys, which is 0 in exact counting
+void HashSimulator::SketchReport(int method, int bitsPerKey, int k)
+{
+    int insertCount = (this->keyCount + 1) / 2;
+    int queryCount = this->keyCount / 2;
+    uint64_t width = (uint64_t)insertCount * bitsPerKey / 32 / k;
+    uint32_t* counters = 0;
+    uint64_t out[FILTER_K_MAX];
+    uint32_t estimate = 0;
+    int frequency = 0;
+    long long over = 0;
+    long long absent = 0;
+    long long updates = 0;
+    chrono::nanoseconds insertNano, queryNano;
+
+    if (width == 0) {
+        width = 1;
+    }
+    counters = new uint32_t[width * k];
+    for (uint64_t i = 0; i < width * k; i++) {
+        counters[i] = 0;
+    }
+
+    // Insert
+    chrono::system_clock::time_point start = chrono::system_clock::now();
+    for (int i = 0; i < this->keyCount; i += 2) {
+        frequency = 1 + (i / 2) % 8;
+
+        for (int f = 0; f < frequency; f++) {
+            this->DeriveIndex(method, i, k, out, 0);
+            for (int j = 0; j < k; j++) {
+                counters[j * width + out[j] % width]++;
+            }
+            updates++;
+        }
+    }
+    chrono::system_clock::time_point end = chrono::system_clock::now();
+    insertNano = end - start;
+
+    // Query, minimum of the rows
+    start = chrono::system_clock::now();
+    for (int i = 0; i < this->keyCount; i++) {
+        this->DeriveIndex(method, i, k, out, 0);
+
+        estimate = UINT32_MAX;
+        for (int j = 0; j < k; j++) {
+            if (counters[j * width + out[j] % width] < estimate) {
+                estimate = counters[j * width + out[j] % width];
+            }
+        }
+
+        if (i % 2 == 0) {
+            frequency = 1 + (i / 2) % 8;
+            assert((int)estimate >= frequency);
+            over += estimate - frequency;
+        } else {
+            absent += estimate;
+        }
+    }
+    end = chrono::system_clock::now();
+    queryNano = end - start;
+
+    cout << FilterMethodName(method) << "	" << width << "x" << k << "	"
+         << (double)over / insertCount << "		"
+         << (queryCount ? (double)absent / queryCount : 0) << "		"
+         << (double)insertNano.count() / updates << "		"
+         << (double)queryNano.count() / this->keyCount << endl;
+
+    delete[] counters;
+}
+
+// Bloom filter and count-min sketch with bitsPerKey bits of memory per
+// inserted key and k indexes per key
+// Every hash is called k times with k seeds, and compared with
+// k values from one MurmurHash3_x64_128 call by double hashing
+void HashSimulator::FilterTest(int bitsPerKey, int k)
+{
+    assert(bitsPerKey > 0);
+    assert(k >= 1 && k <= FILTER_K_MAX);
+
+    cout << "Filter test is started..." << endl;
+    cout << "Inserted keys : " << (this->keyCount + 1) / 2 << ", absent keys : " << this->keyCount / 2
+         << ", bits per key : " << bitsPerKey << ", k : " << k << endl << endl;
+
+    cout << "Bloom filter" << endl;
+    cout << "method		layout	FPR	(theory)	insert(ns)	query(ns)" << endl;
+    for (int h = 0; h < this->HIDCount; h++) {
+        this->BloomReport(this->HIDList[h], false, bitsPerKey, k);
+        this->BloomReport(this->HIDList[h], true, bitsPerKey, k);
+    }
+    this->BloomReport(FILTER_DOUBLE, false, bitsPerKey, k);
+    this->BloomReport(FILTER_DOUBLE, true, bitsPerKey, k);
+    cout << endl;
+
+    cout << "Count-min sketch" << endl;
+    cout << "method		size	over(present)	estimate(absent)	insert(ns)	query(ns)" << endl;
+    for (int h = 0; h < this->HIDCount; h++) {
+        this->SketchReport(this->HIDList[h], bitsPerKey, k);
+    }
+    this->SketchReport(FILTER_DOUBLE, bitsPerKey, k);
+    cout << endl;
+
+    cout << "Filter test is over..." << endl << endl;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+// Shard, keys are placed on the nodes
+///////////////////////////////////////////////////////////////////////////
+
+#define PLACEMENT_JUMP          (0)
+#define PLACEMENT_RENDEZVOUS    (1)
+#define PLACEMENT_RING          (2)
+
+#define PLACEMENT_COUNT         (3)
+
+// Placement method's name list
+static const char* PlacementNameList[] =
+{
+    "Jump",                 // [PLACEMENT_JUMP]
+    "Rendezvous",           // [PLACEMENT_RENDEZVOUS]
+    "Ring",                 // [PLACEMENT_RING]
+};
+
+// Rendezvous uses the vector path from this node count, if the CPU has it
+#define RENDEZVOUS_VECTOR_MIN   (16)
+
+// Place every key on one of the nodes, return the time of the lookups
+// Salts of rendezvous and points of the ring are the hash of (node, vnode),
+// so a node keeps them when the other nodes are added or removed
+long long HashSimulator::Place(HID hid, int method, int nodeCount, int virtualNodes, int* nodeOf)
+{
+    uint32_t* salts = 0;
+    uint32_t* points = 0;
+    int* owners = 0;
+    uint64_t* ring = 0;
+    int pointCount = nodeCount * virtualNodes;
+    uint32_t id[2];
+    chrono::nanoseconds nano;
+    chrono::system_clock::time_point start, end;
+
+    switch (method) {
+    case PLACEMENT_JUMP:
+        start = chrono::system_clock::now();
+        for (int i = 0; i < this->keyCount; i++) {
+            nodeOf[i] = JumpConsistentHash(this->outputSet[i], nodeCount);
+        }
+        end = chrono::system_clock::now();
+        break;
+
+    case PLACEMENT_RENDEZVOUS:
+        salts = new uint32_t[nodeCount];
+        for (int j = 0; j < nodeCount; j++) {
+            id[0] = j;
+            id[1] = 0;
+            HashList[hid](id, sizeof(id), this->seed, &salts[j]);
+        }
+
+        start = chrono::system_clock::now();
+        if (nodeCount >= RENDEZVOUS_VECTOR_MIN && RendezvousVectorSupported()) {
+            for (int i = 0; i < this->keyCount; i++) {
+                nodeOf[i] = RendezvousVector(this->outputSet[i], salts, nodeCount);
+            }
+        } else {
+            for (int i = 0; i < this->keyCount; i++) {
+                nodeOf[i] = RendezvousScalar(this->outputSet[i], salts, nodeCount);
+            }
+        }
+        end = chrono::system_clock::now();
+
+        // Both paths must agree
+        for (int i = 0; i < this->keyCount && i < 1000; i++) {
+            assert(nodeOf[i] == RendezvousScalar(this->outputSet[i], salts, nodeCount));
+        }
+
+        delete[] salts;
+        break;
+
+    case PLACEMENT_RING:
+        // (point << 32 | node) is sorted by point, then by node
+        ring = new uint64_t[pointCount];
+        for (int j = 0; j < nodeCount; j++) {
+            for (int v = 0; v < virtualNodes; v++) {
+                uint32_t point = 0;
+
+                id[0] = j;
+                id[1] = v;
+                HashList[hid](id, sizeof(id), this->seed, &point);
+                ring[j * virtualNodes + v] = (uint64_t)point << 32 | (uint32_t)j;
+            }
+        }
+        sort(ring, ring + pointCount);
+
+        points = new uint32_t[pointCount];
+        owners = new int[pointCount];
+        for (int p = 0; p < pointCount; p++) {
+            points[p] = ring[p] >> 32;
+            owners[p] = (int)(ring[p] & 0xffffffff);
+        }
+
+        start = chrono::system_clock::now();
+        for (int i = 0; i < this->keyCount; i++) {
+            nodeOf[i] = RingLookup(this->outputSet[i], points, owners, pointCount);
+        }
+        end = chrono::system_clock::now();
+
+        delete[] owners;
+        delete[] points;
+        delete[] ring;
+        break;
+    }
+
+    nano = end - start;
+
+    return nano.count();
+}
+
+// Place the key set on nodeCount nodes by every placement method
+// Print the load imbalance (max / average, chi-squared of the loads),
+// the fraction of keys moved when one node is added or the last node is
+// removed, and the lookups per second from the hash codes
+// Ring has virtualNodes points per node
+void HashSimulator::ShardTest(int nodeCount, int virtualNodes)
+{
+    assert(nodeCount >= 2);
+    assert(virtualNodes >= 1);
+
+    int* nodeOf = new int[this->keyCount];
+    int* grownOf = new int[this->keyCount];
+    int* shrunkOf = new int[this->keyCount];
+    int* loads = new int[nodeCount];
+    long long nano = 0;
+    int maxLoad = 0;
+    int grownMoved = 0;
+    int shrunkMoved = 0;
+
+    for (int h = 0; h < this->HIDCount; h++) {
+        HID hid = this->HIDList[h];
+
+        this->MakeOutputSet(hid);
+
+        cout << HashNameList[hid] << "'s shard test is started..." << endl;
+        cout << "Nodes : " << nodeCount << ", virtual nodes of ring : " << virtualNodes
+             << ", rendezvous : " << (nodeCount >= RENDEZVOUS_VECTOR_MIN && RendezvousVectorSupported() ? "vector" : "scalar")
+             << endl;
+        cout << "method		max/avg	chi-squared	moved(+1)	moved(-1)	lookups/s" << endl;
+
+        for (int m = 0; m < PLACEMENT_COUNT; m++) {
+            nano = this->Place(hid, m, nodeCount, virtualNodes, nodeOf);
+            this->Place(hid, m, nodeCount + 1, virtualNodes, grownOf);
+            this->Place(hid, m, nodeCount - 1, virtualNodes, shrunkOf);
+
+            for (int j = 0; j < nodeCount; j++) {
+                loads[j] = 0;
+            }
+
+            grownMoved = 0;
+            shrunkMoved = 0;
+            for (int i = 0; i < this->keyCount; i++) {
+                loads[nodeOf[i]]++;
+
+                if (grownOf[i] != nodeOf[i]) {
+                    grownMoved++;
+                }
+                if (shrunkOf[i] != nodeOf[i]) {
+                    shrunkMoved++;
+                }
+            }
+
+            maxLoad = 0;
+            for (int j = 0; j < nodeCount; j++) {
+                if (loads[j] > maxLoad) {
+                    maxLoad = loads[j];
+                }
+            }
+
+            cout << PlacementNameList[m] << (m == PLACEMENT_RENDEZVOUS ? "	" : "		")
+                 << maxLoad / ((double)this->keyCount / nodeCount) << "	"
+                 << ChiSquared(loads, nodeCount, this->keyCount) << "		"
+                 << (double)grownMoved / this->keyCount << "		"
+                 << (double)shrunkMoved / this->keyCount << "		"
+                 << (nano ? this->keyCount * 1e9 / nano : 0) << endl;
+        }
+
+        // The least possible movement
+        cout << "(ideal moved(+1) : " << 1.0 / (nodeCount + 1)
+             << ", moved(-1) : " << 1.0 / nodeCount << ")" << endl << endl;
+
+        this->ReleaseOutputSet();
+
+        cout << HashNameList[hid] << "'s shard test is over..." << endl << endl;
+    }
+
+    delete[] loads;
+    delete[] shrunkOf;
+    delete[] grownOf;
+    delete[] nodeOf;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+// Concurrency, threads share one table
+///////////////////////////////////////////////////////////////////////////
+
+#define TABLE_STRIPED       (0)
+#define TABLE_LOCK_FREE     (1)
+#define TABLE_SHARDED       (2)
+
+#define TABLE_COUNT         (3)
+
+// Table variant's name list
+static const char* TableNameList[] =
+{
+    "Striped lock",         // [TABLE_STRIPED]
+    "Lock-free",            // [TABLE_LOCK_FREE]
+    "Sharded",              // [TABLE_SHARDED]
+};
+
+// The number of locks of the striped table
+#define STRIPE_COUNT        (256)
+
+// One of this many operations is timed for the latency
+#define LATENCY_SAMPLE      (16)
+
+// Result of one thread, padded so the threads never share a line
+typedef struct alignas(64) threadresult
+{
+    Contention contention;
+    vector<uint32_t> latency; // Sampled latency (ns)
+    long long ops; // Operations done
+} ThreadResult;
+
+// Run the mixed workload on one table with threadCount threads, print one row
+// Even keys are inserted before the run, so about half of the lookups hit
+// Every operation hashes its key, the hash cost is in the numbers
+// Shared tables take any key from any thread
+// Sharded table is per core, thread t only takes the keys of shard t,
+// as a front end routing each request to its owner would do
+void HashSimulator::ConcurrencyRun(HID hid, int variant, int threadCount, int lookupPercent, int opsPerThread)
+{
+    ConcurrentTable* table = 0;
+    ShardedTable* sharded = 0;
+    ThreadResult* results = new ThreadResult[threadCount];
+    vector<vector<int>> owned; // Keys of each thread, sharded table only
+    vector<thread> threads;
+    vector<uint32_t> latency;
+    atomic<int> ready(0);
+    atomic<bool> go(false);
+    Contention prefill = {0, 0};
+    long long waits = 0;
+    long long retries = 0;
+    long long ops = 0;
+    uint32_t code = 0;
+    chrono::nanoseconds nano;
+
+    switch (variant) {
+    case TABLE_STRIPED:
+        table = new StripedTable(this->keySet, this->lengthSet, IndexingList[hid],
+                                 this->keyCount, this->keyCount, STRIPE_COUNT);
+        break;
+    case TABLE_LOCK_FREE:
+        table = new LockFreeTable(this->keySet, this->lengthSet, IndexingList[hid], this->keyCount * 2);
+        break;
+    case TABLE_SHARDED:
+        sharded = new ShardedTable(this->keySet, this->lengthSet, IndexingList[hid],
+                                   this->keyCount / threadCount + 1, threadCount);
+        table = sharded;
+        break;
+    }
+
+    for (int i = 0; i < this->keyCount; i += 2) {
+        HashList[hid](this->keySet[i], this->lengthSet[i], this->seed, &code);
+        table->Insert(i, code, &prefill);
+    }
+
+    // Owner of every key, shard t belongs to thread t
+    if (sharded) {
+        owned.resize(threadCount);
+        for (int i = 0; i < this->keyCount; i++) {
+            HashList[hid](this->keySet[i], this->lengthSet[i], this->seed, &code);
+            owned[sharded->ShardOf(code)].push_back(i);
+        }
+    }
+
+    for (int t = 0; t < threadCount; t++) {
+        threads.push_back(thread([&, t]() {
+            ThreadResult* r = &results[t];
+            uint64_t x = 0x9e3779b97f4a7c15ULL * (t + 1); // xorshift state
+            uint32_t out = 0;
+            int key = 0;
+            bool lookup = false;
+            const int* keys = sharded ? owned[t].data() : 0; // 0 is every key
+            int count = sharded ? (int)owned[t].size() : this->keyCount;
+
+            r->contention.waits = 0;
+            r->contention.retries = 0;
+            r->latency.reserve(opsPerThread / LATENCY_SAMPLE + 1);
+            r->ops = count ? opsPerThread : 0;
+
+            // Start together
+            ready++;
+            while (!go.load(memory_order_acquire)) {
+                this_thread::yield();
+            }
+
+            for (int i = 0; i < r->ops; i++) {
+                x ^= x << 13;
+                x ^= x >> 7;
+                x ^= x << 17;
+                key = (int)((x >> 8) % count);
+                if (keys) {
+                    key = keys[key];
+                }
+                lookup = (int)(x % 100) < lookupPercent;
+
+                if (i % LATENCY_SAMPLE == 0) {
+                    chrono::steady_clock::time_point s = chrono::steady_clock::now();
+                    HashList[hid](this->keySet[key], this->lengthSet[key], this->seed, &out);
+                    if (lookup) {
+                        table->Lookup(key, out, &r->contention);
+                    } else {
+                        table->Insert(key, out, &r->contention);
+                    }
+                    chrono::steady_clock::time_point e = chrono::steady_clock::now();
+
+                    r->latency.push_back((uint32_t)chrono::duration_cast<chrono::nanoseconds>(e - s).count());
+                } else {
+                    HashList[hid](this->keySet[key], this->lengthSet[key], this->seed, &out);
+                    if (lookup) {
+                        table->Lookup(key, out, &r->contention);
+                    } else {
+                        table->Insert(key, out, &r->contention);
+                    }
+                }
+            }
+        }));
+    }
+
+    while (ready.load() != threadCount) {
+        this_thread::yield();
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    go.store(true, memory_order_release);
+    for (int t = 0; t < threadCount; t++) {
+        threads[t].join();
+    }
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+    nano = end - start;
+
+    for (int t = 0; t < threadCount; t++) {
+        waits += results[t].contention.waits;
+        retries += results[t].contention.retries;
+        ops += results[t].ops;
+        latency.insert(latency.end(), results[t].latency.begin(), results[t].latency.end());
+    }
+    sort(latency.begin(), latency.end());
+
+    cout << TableNameList[variant] << (variant == TABLE_SHARDED ? "\t\t" : "\t") << threadCount << "\t"
+         << (double)ops / nano.count() * 1e3 << "\t\t"
+         << latency[latency.size() / 2] << "\t"
+         << latency[latency.size() * 99 / 100] << "\t"
+         << latency[latency.size() * 999 / 1000] << "\t"
+         << waits << "\t" << retries << endl;
+
+    delete table;
+    delete[] results;
+}
+
+// Mixed insert and lookup on a shared table or per core shards, with 1, 2, 4, ... maxThreads threads
+// Print the throughput, sampled latency percentiles and contention counters
+// waits : lock was held by another thread, retries : CAS lost to another thread
+void HashSimulator::ConcurrencyTest(int maxThreads, int lookupPercent, int opsPerThread)
+{
+    assert(maxThreads >= 1);
+    assert(lookupPercent >= 0 && lookupPercent <= 100);
+    assert(opsPerThread >= 1);
+    assert(this->keyCount >= 1);
+
+    for (int h = 0; h < this->HIDCount; h++) {
+        HID hid = this->HIDList[h];
+
+        cout << HashNameList[hid] << "'s concurrency test is started..." << endl;
+        cout << "Lookups : " << lookupPercent << "%, operations per thread : " << opsPerThread
+             << ", cores : " << thread::hardware_concurrency() << endl;
+        cout << "table\t\tthreads\tMops/s\t\tp50\tp99\tp99.9(ns)\twaits\tretries" << endl;
+
+        for (int v = 0; v < TABLE_COUNT; v++) {
+            for (int t = 1; t < maxThreads; t *= 2) {
+                this->ConcurrencyRun(hid, v, t, lookupPercent, opsPerThread);
+            }
+            this->ConcurrencyRun(hid, v, maxThreads, lookupPercent, opsPerThread);
+        }
+        cout << endl;
+
+        cout << HashNameList[hid] << "'s concurrency test is over..." << endl << endl;
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+// Group probe, SwissTable style metadata groups
+///////////////////////////////////////////////////////////////////////////
+
+// How the hash code is split into H1 (group) and H2 (7 bit tag)
+#define TAG_LOW             (0) // H1 = code >> 7, H2 = code & 0x7f
+#define TAG_HIGH            (1) // H1 = code & 0x1ffffff, H2 = code >> 25
+
+#define TAG_SPLIT_COUNT     (2)
+
+// Split's name list
+static const char* TagSplitNameList[] =
+{
+    "Low 7 bits",           // [TAG_LOW]
+    "High 7 bits",          // [TAG_HIGH]
+};
+
+#define GROUP_SIZE          (16)
+#define CTRL_EMPTY          (0x80) // Full slot is 0x00 ~ 0x7f, the tag
+
+static inline uint32_t SplitH1(uint32_t code, int split)
+{
+    return split == TAG_LOW ? code >> 7 : code & 0x1ffffff;
+}
+
+static inline uint8_t SplitH2(uint32_t code, int split)
+{
+    return split == TAG_LOW ? code & 0x7f : code >> 25;
+}
+
+// Bit i is set if ctrl[i] == h, one bit per slot of the group
+static inline uint32_t MatchGroup(const uint8_t* ctrl, uint8_t h, bool simd)
+{
+#if defined(__SSE2__)
+    if (simd) {
+        __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8((char)h), group));
+    }
+#endif
+
+    uint32_t mask = 0;
+
+    for (int i = 0; i < GROUP_SIZE; i++) {
+        if (ctrl[i] == h) {
+            mask |= 1u << i;
+        }
+    }
+
+    return mask;
+}
+
+// Even keys are inserted, then every key is looked up
+// Odd keys are absent, a lookup stops at a group with an empty slot
+// Print the actual load, the groups probed per lookup,
+// tag false matches per probed group with the ideal one at the actual load,
+// and the lookup time with SSE2 group match and with byte by byte match
+void HashSimulator::GroupProbeRun(int split, double maxLoad)
+{
+    int insertCount = (this->keyCount + 1) / 2;
+    int groupCount = 1;
+    double load = 0;
+    uint8_t* ctrl = 0;
+    int* slots = 0;
+    uint32_t mask = 0;
+    uint32_t code = 0;
+    uint32_t g = 0;
+    uint8_t h2 = 0;
+    long long groups[2] = {0, 0}; // [absent, present]
+    long long falseMatches[2] = {0, 0};
+    int lookups[2] = {0, 0};
+    int found = 0;
+    chrono::nanoseconds nano[2];
+
+    // Power of two groups, under maxLoad
+    while ((double)insertCount > maxLoad * groupCount * GROUP_SIZE) {
+        groupCount *= 2;
+    }
+
+    load = (double)insertCount / ((double)groupCount * GROUP_SIZE);
+
+    ctrl = new uint8_t[groupCount * GROUP_SIZE];
+    slots = new int[groupCount * GROUP_SIZE];
+    for (int i = 0; i < groupCount * GROUP_SIZE; i++) {
+        ctrl[i] = CTRL_EMPTY;
+    }
+
+    // Insert, triangular probing over the groups visits every group
+    for (int i = 0; i < this->keyCount; i += 2) {
+        code = this->outputSet[i];
+        g = SplitH1(code, split) & (groupCount - 1);
+
+        for (int step = 1; ; step++) {
+            mask = MatchGroup(&ctrl[g * GROUP_SIZE], CTRL_EMPTY, true);
+            if (mask) {
+                int slot = g * GROUP_SIZE + __builtin_ctz(mask);
+
+                ctrl[slot] = SplitH2(code, split);
+                slots[slot] = i;
+                break;
+            }
+            g = (g + step) & (groupCount - 1);
+        }
+    }
+
+    // Lookup, the first pass counts, both passes are timed
+    for (int pass = 0; pass < 2; pass++) {
+        bool simd = pass == 0;
+
+        found = 0;
+        chrono::system_clock::time_point start = chrono::system_clock::now();
+        for (int i = 0; i < this->keyCount; i++) {
+            bool present = false;
+
+            code = this->outputSet[i];
+            g = SplitH1(code, split) & (groupCount - 1);
+            h2 = SplitH2(code, split);
+
+            for (int step = 1; ; step++) {
+                const uint8_t* group = &ctrl[g * GROUP_SIZE];
+
+                if (pass == 0) {
+                    groups[i % 2 == 0]++;
+                }
+
+                // Compare the keys of the tag matched slots only
+                mask = MatchGroup(group, h2, simd);
+                while (mask) {
+                    int k = slots[g * GROUP_SIZE + __builtin_ctz(mask)];
+
+                    if (this->outputSet[k] == code && this->lengthSet[k] == this->lengthSet[i] &&
+                        memcmp(this->keySet[k], this->keySet[i], this->lengthSet[i]) == 0) {
+                        present = true;
+                        break;
+                    }
+
+                    if (pass == 0) {
+                        falseMatches[i % 2 == 0]++;
+                    }
+                    mask &= mask - 1;
+                }
+
+                if (present || MatchGroup(group, CTRL_EMPTY, simd)) {
+                    break;
+                }
+                g = (g + step) & (groupCount - 1);
+            }
+
+            if (present) {
+                found++;
+            }
+            if (pass == 0) {
+                lookups[i % 2 == 0]++;
+            }
+        }
+        chrono::system_clock::time_point end = chrono::system_clock::now();
+
+        nano[pass] = end - start;
+        assert(found >= insertCount);
+    }
+
+    cout << TagSplitNameList[split] << "\t" << load << "\t"
+         << (double)groups[1] / lookups[1] << "\t\t"
+         << (lookups[0] ? (double)groups[0] / lookups[0] : 0) << "\t\t"
+         << (double)falseMatches[1] / groups[1] << "\t\t"
+         << (groups[0] ? (double)falseMatches[0] / groups[0] : 0) << "\t\t"
+         << GROUP_SIZE * load / 128 << "\t"
+         << (double)nano[0].count() / this->keyCount << "\t"
+         << (double)nano[1].count() / this->keyCount << endl;
+
+    delete[] slots;
+    delete[] ctrl;
+}
+
+// Simulate a table of 16 slot groups with 7 bit tags, as SwissTable
+// The code is split into H1 (group index) and H2 (tag) from the low bits
+// and from the high bits, so weak bits of the hash are shown in the tag
+// Ideal hash has about (16 * load / 128) false matches per probed group,
+// load is the actual one, groups are a power of two under maxLoad
+void HashSimulator::GroupProbeTest(double maxLoad)
+{
+    assert(HASH_CODE_SIZE == 32);
+    assert(maxLoad > 0 && maxLoad < 1);
+
+    for (int h = 0; h < this->HIDCount; h++) {
+        HID hid = this->HIDList[h];
+
+        this->MakeOutputSet(hid);
+
+        cout << HashNameList[hid] << "'s group probe test is started..." << endl;
+        cout << "Inserted keys : " << (this->keyCount + 1) / 2 << ", absent keys : " << this->keyCount / 2
+             << ", max load : " << maxLoad << endl;
+#if !defined(__SSE2__)
+        cout << "(SSE2 is not available, both columns are byte by byte match)" << endl;
+#endif
+        cout << "tag\t\tload\tgroups(hit)\tgroups(miss)\tfalse(hit)\tfalse(miss)\tideal\tSSE2(ns)\tscalar(ns)" << endl;
+
+        for (int split = 0; split < TAG_SPLIT_COUNT; split++) {
+            this->GroupProbeRun(split, maxLoad);
+        }
+        cout << "(false matches are per probed group, ideal is 16 * load / 128)" << endl << endl;
+
+        this->ReleaseOutputSet();
+
+        cout << HashNameList[hid] << "'s group probe test is over..." << endl << endl;
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+// Ingest, reading and hashing of a key file are overlapped
+///////////////////////////////////////////////////////////////////////////
+
+// Buffers of the pipeline per worker
+#define INGEST_BUFFERS_PER_WORKER (4)
+
+// Read the file of newline separated keys and hash every key with every hash
+// One reader (io_uring, or pread) fills the buffers, workerCount workers hash them
+// Workers fill their own bins, they are merged when the file is over,
+// so the hashing loop never writes to a shared line
+// The keys are not kept, only chi-squared and FillFactor are tested
+// Reader's stall is the time hashing was behind, workers' idle is the time
+// reading was behind
+void HashSimulator::IngestFile(const char* path, int workerCount)
+{
+    assert(workerCount >= 1);
+
+    IngestPipeline pipeline;
+    int bufferCount = workerCount * INGEST_BUFFERS_PER_WORKER + INGEST_DEPTH;
+    int* workerBins = new int[(size_t)workerCount * this->HIDCount * this->binCount];
+    long long* workerKeys = new long long[workerCount];
+    long long* workerIdle = new long long[workerCount];
+    vector<thread> workers;
+    long long keys = 0;
+    long long idle = 0;
+    bool ok = false;
+    chrono::nanoseconds nano;
+
+    for (size_t i = 0; i < (size_t)workerCount * this->HIDCount * this->binCount; i++) {
+        workerBins[i] = 0;
+    }
+
+    IngestInit(&pipeline, bufferCount, workerCount);
+
+    cout << "Ingest of " << path << " is started..." << endl;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int w = 0; w < workerCount; w++) {
+        workers.push_back(thread([&, w]() {
+            int* bins = &workerBins[(size_t)w * this->HIDCount * this->binCount];
+            long long count = 0;
+            long long idleNano = 0;
+            uint32_t out = 0;
+            int buffer = -1;
+
+            while ((buffer = IngestPop(&pipeline, &idleNano)) != -1) {
+                IngestBuffer* b = &pipeline.buffers[buffer];
+                char* key = b->data + b->begin;
+                char* end = b->data + b->end;
+
+                while (key < end) {
+                    char* nl = (char*)memchr(key, '\n', end - key);
+                    int length = (int)(nl - key);
+
+                    // Windows line end
+                    if (length > 0 && key[length - 1] == '\r') {
+                        length--;
+                    }
+
+                    if (length > 0) {
+                        for (int h = 0; h < this->HIDCount; h++) {
+                            HID hid = this->HIDList[h];
+
+                            HashList[hid](key, length, this->seed, &out);
+                            bins[h * this->binCount + IndexingList[hid](this->binCount, &out)]++;
+                        }
+                        count++;
+                    }
+
+                    key = nl + 1;
+                }
+
+                IngestRelease(&pipeline, buffer);
+            }
+
+            workerKeys[w] = count;
+            workerIdle[w] = idleNano;
+        }));
+    }
+
+    ok = IngestRead(&pipeline, path, workerCount);
+
+    for (int w = 0; w < workerCount; w++) {
+        workers[w].join();
+    }
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+    nano = end - start;
+
+    for (int w = 0; w < workerCount; w++) {
+        keys += workerKeys[w];
+        idle += workerIdle[w];
+    }
+
+    // Nothing to report, statistics of 0 keys are not defined
+    if (!ok || keys == 0) {
+        if (!ok) {
+            cout << "Reading " << path << " is failed" << endl;
+        } else {
+            cout << "There is no key in " << path << endl;
+        }
+
+        IngestFree(&pipeline);
+
+        delete[] workerIdle;
+        delete[] workerKeys;
+        delete[] workerBins;
+
+        cout << "Ingest of " << path << " is over..." << endl << endl;
+        return;
+    }
+
+    cout << "Reader : " << (pipeline.uring ? "io_uring" : "pread")
+         << (pipeline.uringFailed ? " (io_uring submission is failed)" : "")
+         << ", workers : " << workerCount << endl;
+    cout << "Size of key set : " << keys << " (" << pipeline.skipped << " keys over "
+         << INGEST_SLACK << " bytes across buffers are skipped)" << endl;
+    cout << "Read : " << pipeline.bytes << "(bytes), " << pipeline.bytes / 1e6 / (nano.count() / 1e9) << "(MB/s)" << endl;
+    cout << "Speed : " << nano.count() << "(ns), " << keys / (nano.count() / 1e9) << "(keys/s)" << endl;
+    cout << "Reader stall : " << pipeline.stallNano << "(ns), worker idle : "
+         << idle / workerCount << "(ns) on average" << endl << endl;
+
+    // Merge the bins of the workers, per hash
+    for (int h = 0; h < this->HIDCount; h++) {
+        HID hid = this->HIDList[h];
+
+        for (int i = 0; i < this->binCount; i++) {
+            this->bins[i] = 0;
+            for (int w = 0; w < workerCount; w++) {
+                this->bins[i] += workerBins[((size_t)w * this->HIDCount + h) * this->binCount + i];
+            }
+        }
+
+        cout << HashNameList[hid] << "'s Chi-squared value : "
+             << ChiSquared(this->bins, this->binCount, (int)keys) << ", DOF : " << this->binCount << endl;
+        cout << HashNameList[hid] << "'s FillFactor : "
+             << WastedPercent(this->bins, this->binCount, (int)keys) << "% is wasted..." << endl << endl;
+
+        // Empty the bins
+        for (int i = 0; i < this->binCount; i++) {
+            this->bins[i] = 0;
+        }
+    }
+
+    IngestFree(&pipeline);
+
+    delete[] workerIdle;
+    delete[] workerKeys;
+    delete[] workerBins;
+
+    cout << "Ingest of " << path << " is over..." << endl << endl;
+}
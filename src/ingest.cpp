@@ -0,0 +1,579 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define INGEST_URING
+#endif
+
+#include "../include/ingest.h"
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////
+// Ring
+///////////////////////////////////////////////////////////////////////////
+
+IngestRing::IngestRing(int capacity)
+{
+    size_t size = 1;
+
+    while (size < (size_t)capacity) {
+        size *= 2;
+    }
+
+    this->cells = new Cell[size];
+    this->mask = size - 1;
+    this->tail.store(0);
+    this->head.store(0);
+
+    // Cell i is free for the push of sequence i
+    for (size_t i = 0; i < size; i++) {
+        this->cells[i].sequence.store(i);
+    }
+}
+
+IngestRing::~IngestRing()
+{
+    delete[] this->cells;
+}
+
+bool IngestRing::Push(int value)
+{
+    size_t pos = this->tail.load(memory_order_relaxed);
+    Cell* cell = 0;
+    intptr_t diff = 0;
+
+    for (;;) {
+        cell = &this->cells[pos & this->mask];
+        diff = (intptr_t)cell->sequence.load(memory_order_acquire) - (intptr_t)pos;
+
+        if (diff == 0) {
+            // Cell is free, claim the position
+            if (this->tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false; // Full
+        } else {
+            pos = this->tail.load(memory_order_relaxed);
+        }
+    }
+
+    cell->value = value;
+    cell->sequence.store(pos + 1, memory_order_release);
+
+    return true;
+}
+
+bool IngestRing::Pop(int* value)
+{
+    size_t pos = this->head.load(memory_order_relaxed);
+    Cell* cell = 0;
+    intptr_t diff = 0;
+
+    for (;;) {
+        cell = &this->cells[pos & this->mask];
+        diff = (intptr_t)cell->sequence.load(memory_order_acquire) - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            // Cell is filled, claim the position
+            if (this->head.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false; // Empty
+        } else {
+            pos = this->head.load(memory_order_relaxed);
+        }
+    }
+
+    *value = cell->value;
+    cell->sequence.store(pos + this->mask + 1, memory_order_release);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// io_uring, raw system calls
+///////////////////////////////////////////////////////////////////////////
+
+#if defined(INGEST_URING)
+
+typedef struct uring
+{
+    int fd;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    io_uring_sqe* sqes;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    io_uring_cqe* cqes;
+    void* sqMap;
+    size_t sqMapSize;
+    void* cqMap;
+    size_t cqMapSize;
+    size_t sqesSize;
+} Uring;
+
+// Return false if io_uring is not available (old kernel, seccomp, ...)
+static bool UringInit(Uring* u, unsigned entries)
+{
+    io_uring_params params;
+
+    memset(&params, 0, sizeof(params));
+    memset(u, 0, sizeof(*u));
+
+    u->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (u->fd < 0) {
+        return false;
+    }
+
+    u->sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    u->cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    // One mapping for both rings on newer kernels
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (u->cqMapSize > u->sqMapSize) {
+            u->sqMapSize = u->cqMapSize;
+        }
+    }
+
+    u->sqMap = mmap(0, u->sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    u->fd, IORING_OFF_SQ_RING);
+    if (u->sqMap == MAP_FAILED) {
+        close(u->fd);
+        return false;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        u->cqMap = u->sqMap;
+        u->cqMapSize = 0;
+    } else {
+        u->cqMap = mmap(0, u->cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        u->fd, IORING_OFF_CQ_RING);
+        if (u->cqMap == MAP_FAILED) {
+            munmap(u->sqMap, u->sqMapSize);
+            close(u->fd);
+            return false;
+        }
+    }
+
+    u->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    u->sqes = (io_uring_sqe*)mmap(0, u->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                  u->fd, IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED) {
+        if (u->cqMapSize) {
+            munmap(u->cqMap, u->cqMapSize);
+        }
+        munmap(u->sqMap, u->sqMapSize);
+        close(u->fd);
+        return false;
+    }
+
+    u->sqHead = (unsigned*)((char*)u->sqMap + params.sq_off.head);
+    u->sqTail = (unsigned*)((char*)u->sqMap + params.sq_off.tail);
+    u->sqMask = (unsigned*)((char*)u->sqMap + params.sq_off.ring_mask);
+    u->sqArray = (unsigned*)((char*)u->sqMap + params.sq_off.array);
+    u->cqHead = (unsigned*)((char*)u->cqMap + params.cq_off.head);
+    u->cqTail = (unsigned*)((char*)u->cqMap + params.cq_off.tail);
+    u->cqMask = (unsigned*)((char*)u->cqMap + params.cq_off.ring_mask);
+    u->cqes = (io_uring_cqe*)((char*)u->cqMap + params.cq_off.cqes);
+
+    return true;
+}
+
+static void UringFree(Uring* u)
+{
+    munmap(u->sqes, u->sqesSize);
+    if (u->cqMapSize) {
+        munmap(u->cqMap, u->cqMapSize);
+    }
+    munmap(u->sqMap, u->sqMapSize);
+    close(u->fd);
+}
+
+// Submit one read, user data is the buffer index
+// Return false if it is not submitted, the entry is taken back from the queue
+static bool UringRead(Uring* u, int fd, void* data, int length, long long offset, int buffer)
+{
+    unsigned tail = *u->sqTail;
+    unsigned index = tail & *u->sqMask;
+    io_uring_sqe* sqe = &u->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (unsigned long)data;
+    sqe->len = length;
+    sqe->off = offset;
+    sqe->user_data = buffer;
+
+    u->sqArray[index] = index;
+    __atomic_store_n(u->sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    if (syscall(__NR_io_uring_enter, u->fd, 1, 0, 0, 0, 0) == 1) {
+        return true;
+    }
+
+    // Kernel took the entry anyway, its completion will come
+    if (__atomic_load_n(u->sqHead, __ATOMIC_ACQUIRE) != tail) {
+        return true;
+    }
+
+    // Roll the tail back, a later enter must not submit it again
+    __atomic_store_n(u->sqTail, tail, __ATOMIC_RELEASE);
+
+    return false;
+}
+
+// Wait for one completion
+static bool UringWait(Uring* u, int* buffer, int* result)
+{
+    unsigned head = *u->cqHead;
+
+    while (head == __atomic_load_n(u->cqTail, __ATOMIC_ACQUIRE)) {
+        if (syscall(__NR_io_uring_enter, u->fd, 0, 1, IORING_ENTER_GETEVENTS, 0, 0) < 0 &&
+            errno != EINTR) {
+            return false;
+        }
+    }
+
+    io_uring_cqe* cqe = &u->cqes[head & *u->cqMask];
+    *buffer = (int)cqe->user_data;
+    *result = cqe->res;
+    __atomic_store_n(u->cqHead, head + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+#endif // INGEST_URING
+
+///////////////////////////////////////////////////////////////////////////
+// Pipeline
+///////////////////////////////////////////////////////////////////////////
+
+void IngestInit(IngestPipeline* p, int bufferCount, int workerCount)
+{
+    p->buffers = new IngestBuffer[bufferCount];
+    p->bufferCount = bufferCount;
+
+    // Full ring also holds the end of every worker
+    p->freeRing = new IngestRing(bufferCount);
+    p->fullRing = new IngestRing(bufferCount + workerCount);
+
+    for (int i = 0; i < bufferCount; i++) {
+        p->buffers[i].data = new char[INGEST_SLACK + INGEST_CHUNK + INGEST_PAD];
+        p->buffers[i].begin = 0;
+        p->buffers[i].end = 0;
+        p->freeRing->Push(i);
+    }
+
+    p->uring = false;
+    p->uringFailed = false;
+    p->bytes = 0;
+    p->skipped = 0;
+    p->stallNano = 0;
+}
+
+void IngestFree(IngestPipeline* p)
+{
+    for (int i = 0; i < p->bufferCount; i++) {
+        delete[] p->buffers[i].data;
+    }
+
+    delete p->fullRing;
+    delete p->freeRing;
+    delete[] p->buffers;
+
+    p->buffers = 0;
+    p->bufferCount = 0;
+    p->freeRing = 0;
+    p->fullRing = 0;
+}
+
+// pread until the buffer is filled, return false on error
+static bool ReadAll(int fd, IngestBuffer* b, int from)
+{
+    ssize_t n = 0;
+
+    while (from < b->length) {
+        n = pread(fd, b->data + INGEST_SLACK + from, b->length - from, b->offset + from);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        from += n;
+    }
+
+    return true;
+}
+
+// Take a free buffer, wait if there is none
+static int TakeFree(IngestPipeline* p)
+{
+    int buffer = -1;
+
+    if (p->freeRing->Pop(&buffer)) {
+        return buffer;
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while (!p->freeRing->Pop(&buffer)) {
+        this_thread::yield();
+    }
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+    p->stallNano += chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+
+    return buffer;
+}
+
+static void PushFull(IngestPipeline* p, int buffer)
+{
+    while (!p->fullRing->Push(buffer)) {
+        this_thread::yield();
+    }
+}
+
+// Reads are completed out of order, but buffers are handed over in file order,
+// because the partial key at the end of a buffer is moved to the slack
+// in front of the next one
+bool IngestRead(IngestPipeline* p, const char* path, int workerCount)
+{
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    long long size = 0;
+    long long offset = 0;
+    int* order = new int[p->bufferCount]; // Buffers in file order, ring of depth
+    int submitted = 0; // Reads submitted
+    int processed = 0; // Reads handed over
+    int depth = p->bufferCount / 2 < INGEST_DEPTH ? p->bufferCount / 2 : INGEST_DEPTH;
+    char carry[INGEST_SLACK]; // Partial key of the previous buffer
+    int carryLength = 0;
+    bool dropping = false; // Skipping a key longer than INGEST_SLACK
+    bool ok = true;
+#if defined(INGEST_URING)
+    Uring u;
+    bool uringReady = false; // Ring is made, completions must be waited
+    bool useUring = false; // New reads go to the ring
+#endif
+
+    if (depth < 1) {
+        depth = 1;
+    }
+
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        ok = false;
+        goto end;
+    }
+    size = st.st_size;
+
+#if defined(INGEST_URING)
+    uringReady = UringInit(&u, INGEST_DEPTH);
+    useUring = uringReady;
+    p->uring = uringReady;
+#endif
+
+    while (ok) {
+        // Keep the reads in flight
+        while (submitted - processed < depth && offset < size) {
+            int buffer = -1;
+            IngestBuffer* b = 0;
+
+            // Never wait for a free buffer while reads are in flight,
+            // the workers may be waiting for them
+            if (submitted == processed) {
+                buffer = TakeFree(p);
+            } else if (!p->freeRing->Pop(&buffer)) {
+                break;
+            }
+
+            b = &p->buffers[buffer];
+            b->offset = offset;
+            b->length = size - offset < INGEST_CHUNK ? (int)(size - offset) : INGEST_CHUNK;
+            b->done = false;
+            offset += b->length;
+            order[submitted % p->bufferCount] = buffer;
+            submitted++;
+
+#if defined(INGEST_URING)
+            if (useUring) {
+                if (UringRead(&u, fd, b->data + INGEST_SLACK, b->length, b->offset, buffer)) {
+                    continue;
+                }
+                // Submission is failed, pread from now on
+                useUring = false;
+                p->uring = false;
+                p->uringFailed = true;
+            }
+#endif
+            b->done = ReadAll(fd, b, 0);
+            if (!b->done) {
+                ok = false;
+            }
+        }
+
+        if (submitted == processed) {
+            break;
+        }
+
+        // Wait for the next buffer in file order
+        IngestBuffer* b = &p->buffers[order[processed % p->bufferCount]];
+
+#if defined(INGEST_URING)
+        while (ok && uringReady && !b->done) {
+            int buffer = -1;
+            int result = 0;
+
+            if (!UringWait(&u, &buffer, &result)) {
+                ok = false;
+                break;
+            }
+
+            // Error or short read, the rest is read by pread
+            IngestBuffer* c = &p->buffers[buffer];
+            c->done = ReadAll(fd, c, result > 0 ? result : 0);
+            if (!c->done) {
+                ok = false;
+            }
+        }
+#endif
+        if (!ok) {
+            break;
+        }
+
+        char* body = b->data + INGEST_SLACK;
+        int start = INGEST_SLACK;
+        int last = -1;
+
+        p->bytes += b->length;
+
+        // Rest of a dropped key is skipped
+        if (dropping) {
+            char* nl = (char*)memchr(body, '\n', b->length);
+
+            if (nl == 0) {
+                IngestRelease(p, order[processed % p->bufferCount]);
+                processed++;
+                continue;
+            }
+            start = INGEST_SLACK + (int)(nl - body) + 1;
+            dropping = false;
+        } else {
+            memcpy(body - carryLength, carry, carryLength);
+            start = INGEST_SLACK - carryLength;
+        }
+        carryLength = 0;
+
+        // Keys end at the last newline, the rest goes to the next buffer
+        for (int i = INGEST_SLACK + b->length - 1; i >= start; i--) {
+            if (b->data[i] == '\n') {
+                last = i;
+                break;
+            }
+        }
+
+        int tailStart = last == -1 ? start : last + 1;
+        int tailLength = INGEST_SLACK + b->length - tailStart;
+
+        if (tailLength > INGEST_SLACK) {
+            dropping = true;
+            p->skipped++;
+        } else {
+            memcpy(carry, b->data + tailStart, tailLength);
+            carryLength = tailLength;
+        }
+
+        b->begin = start;
+        b->end = last == -1 ? start : last + 1;
+        if (b->end > b->begin) {
+            PushFull(p, order[processed % p->bufferCount]);
+        } else {
+            IngestRelease(p, order[processed % p->bufferCount]);
+        }
+        processed++;
+    }
+
+    // Last key without a newline
+    if (ok && carryLength > 0) {
+        int buffer = TakeFree(p);
+        IngestBuffer* b = &p->buffers[buffer];
+
+        memcpy(b->data + INGEST_SLACK, carry, carryLength);
+        b->data[INGEST_SLACK + carryLength] = '\n';
+        b->begin = INGEST_SLACK;
+        b->end = INGEST_SLACK + carryLength + 1;
+        PushFull(p, buffer);
+    }
+
+#if defined(INGEST_URING)
+    // Reads still in flight must land before the buffers are freed
+    if (uringReady) {
+        while (submitted > processed) {
+            int buffer = -1;
+            int result = 0;
+
+            if (p->buffers[order[processed % p->bufferCount]].done) {
+                processed++;
+                continue;
+            }
+            if (!UringWait(&u, &buffer, &result)) {
+                break;
+            }
+            p->buffers[buffer].done = true;
+        }
+        UringFree(&u);
+    }
+#endif
+
+end:
+    // Every worker gets its end
+    for (int i = 0; i < workerCount; i++) {
+        PushFull(p, -1);
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+    delete[] order;
+
+    return ok;
+}
+
+int IngestPop(IngestPipeline* p, long long* idleNano)
+{
+    int buffer = -1;
+
+    if (p->fullRing->Pop(&buffer)) {
+        return buffer;
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while (!p->fullRing->Pop(&buffer)) {
+        this_thread::yield();
+    }
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+    *idleNano += chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+
+    return buffer;
+}
+
+void IngestRelease(IngestPipeline* p, int buffer)
+{
+    // Free ring holds every buffer, it is never full
+    p->freeRing->Push(buffer);
+}
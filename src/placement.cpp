@@ -0,0 +1,170 @@
+#include <string.h>
+
+#include "../include/types.h"
+
+/* Placement of a hash code on one of the nodes
+ * Jump consistent hash, rendezvous (highest random weight), ring */
+
+// Jump consistent hash (Lamping, Veach)
+// Key jumps forward while the next jump is in the range
+int JumpConsistentHash(uint64_t key, int nodeCount)
+{
+    int64_t b = -1;
+    int64_t j = 0;
+
+    while (j < nodeCount) {
+        b = j;
+        key = key * 2862933555777941757ULL + 1;
+        j = (int64_t)((b + 1) * ((double)(1LL << 31) / (double)((key >> 33) + 1)));
+    }
+
+    return (int)b;
+}
+
+// Weight of the code on the node, fmix32 of code ^ salt
+static inline uint32_t Weight(uint32_t code, uint32_t salt)
+{
+    uint32_t h = code ^ salt;
+
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+
+    return h;
+}
+
+// Rendezvous, the node of the highest weight
+// Tie goes to the lowest node
+int RendezvousScalar(uint32_t code, const uint32_t* salts, int nodeCount)
+{
+    uint32_t best = 0;
+    uint32_t w = 0;
+    int node = 0;
+
+    for (int j = 0; j < nodeCount; j++) {
+        w = Weight(code, salts[j]);
+        if (j == 0 || w > best) {
+            best = w;
+            node = j;
+        }
+    }
+
+    return node;
+}
+
+// Vector path needs a 32 bit vector multiply
+// SSE2 has none, the emulated multiply is slower than the scalar loop,
+// so x86 builds without AVX2 compile it for AVX2 and check the CPU at run time
+#if defined(__AVX2__) || defined(__ARM_NEON)
+#define RENDEZVOUS_VECTOR
+#define RENDEZVOUS_TARGET
+#elif (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define RENDEZVOUS_VECTOR
+#define RENDEZVOUS_TARGET __attribute__ ((target("avx2")))
+#define RENDEZVOUS_CPU_CHECK
+#endif
+
+// Return true if RendezvousVector is faster than RendezvousScalar here
+bool RendezvousVectorSupported()
+{
+#if defined(RENDEZVOUS_CPU_CHECK)
+    return __builtin_cpu_supports("avx2");
+#elif defined(RENDEZVOUS_VECTOR)
+    return true;
+#else
+    return false;
+#endif
+}
+
+#if defined(RENDEZVOUS_VECTOR)
+
+// 8 lanes, one AVX2 register
+#define RENDEZVOUS_LANES (8)
+
+typedef uint32_t v8u32 __attribute__ ((vector_size(RENDEZVOUS_LANES * 4)));
+typedef int32_t v8i32 __attribute__ ((vector_size(RENDEZVOUS_LANES * 4)));
+
+// Rendezvous, 8 nodes at a time
+// Each lane keeps its own best, then the lanes are reduced
+// Same result as RendezvousScalar, call it only if RendezvousVectorSupported
+RENDEZVOUS_TARGET
+int RendezvousVector(uint32_t code, const uint32_t* salts, int nodeCount)
+{
+    int vectorCount = nodeCount / RENDEZVOUS_LANES * RENDEZVOUS_LANES;
+    v8u32 best = {0, 0, 0, 0, 0, 0, 0, 0};
+    v8i32 bestNode = {-1, -1, -1, -1, -1, -1, -1, -1};
+    v8i32 node = {0, 1, 2, 3, 4, 5, 6, 7};
+    v8u32 h;
+    uint32_t bestWeight = 0;
+    uint32_t w = 0;
+    int result = -1;
+
+    for (int j = 0; j < vectorCount; j += RENDEZVOUS_LANES) {
+        memcpy(&h, salts + j, sizeof(h));
+
+        h ^= code;
+        h ^= h >> 16;
+        h *= 0x85ebca6b;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35;
+        h ^= h >> 16;
+
+        // First round takes every lane, later rounds only the higher ones
+        v8i32 take = (v8i32)(h > best) | (bestNode < 0);
+        best = take ? h : best;
+        bestNode = take ? node : bestNode;
+        node += RENDEZVOUS_LANES;
+    }
+
+    // Reduce the lanes, lowest node on tie
+    for (int l = 0; l < RENDEZVOUS_LANES && vectorCount != 0; l++) {
+        if (result == -1 || best[l] > bestWeight ||
+            (best[l] == bestWeight && bestNode[l] < result)) {
+            bestWeight = best[l];
+            result = bestNode[l];
+        }
+    }
+
+    // The remainder
+    for (int j = vectorCount; j < nodeCount; j++) {
+        w = Weight(code, salts[j]);
+        if (result == -1 || w > bestWeight) {
+            bestWeight = w;
+            result = j;
+        }
+    }
+
+    return result;
+}
+
+#else
+
+// No fast vector multiply, same as RendezvousScalar
+int RendezvousVector(uint32_t code, const uint32_t* salts, int nodeCount)
+{
+    return RendezvousScalar(code, salts, nodeCount);
+}
+
+#endif
+
+// Ring, the owner of the first point at or after the code
+// points are sorted, the last point wraps to the first
+int RingLookup(uint32_t code, const uint32_t* points, const int* owners, int pointCount)
+{
+    int low = 0;
+    int high = pointCount;
+    int mid = 0;
+
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (points[mid] < code) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return owners[low == pointCount ? 0 : low];
+}